@@ -10,11 +10,337 @@
        from a single node.
 *******************************************************************************/
 #include "ALGraph.h"
-#include <algorithm> //needed for std::sort to sort from small to large
+#include "MappedFile.h" //used by LoadBinary
+#include <algorithm> //needed for std::sort to sort from small to large, and the heap functions
+#include <atomic> //used to hand out sources to threads
+#include <cstdio> //used to read text files in chunks and to replace a saved file
+#include <cstring> //used to check the header of a graph file
+#include <fstream> //used by SaveBinary
+#include <string> //used for the temporary file name
+#include <thread> //used for DistanceMatrix
 
 
 const unsigned INFINITY_ = static_cast<unsigned>(-1);
 
+//AUTO uses Dial's buckets up to this edge weight, a radix heap above it
+const unsigned DIAL_AUTO_MAX_WEIGHT = 1024;
+
+//Dial needs one bucket per possible edge weight, past this a radix heap is used even if asked for Dial
+const unsigned DIAL_MAX_WEIGHT = 1 << 16;
+
+//buckets of a radix heap over unsigned keys, one for the last key and one per bit
+const unsigned RADIX_BUCKETS = 33;
+
+//orders edges like check_smaller_than, but equal weights by the ids the caller gave
+//the nodes, so adjacency lists keep the same order after the graph is reordered
+struct check_smaller_original_id {
+    const unsigned* external_id;
+
+    bool operator()(const AdjacencyInfo& lhs, const AdjacencyInfo& rhs) const {
+        if(lhs.weight != rhs.weight){
+            return lhs.weight < rhs.weight;
+        }
+        if(!external_id){
+            return lhs.id < rhs.id;
+        }
+        return external_id[lhs.id-1] < external_id[rhs.id-1];
+    }
+};
+
+//graph files start with this, followed by the version they were written with
+const char GRAPH_FILE_MAGIC[8] = { 'A', 'L', 'G', 'R', 'A', 'P', 'H', '\0' };
+const unsigned GRAPH_FILE_VERSION = 2;
+
+//every array of a graph file starts on a multiple of this, so it can be read in place
+const unsigned long long GRAPH_FILE_ALIGNMENT = 64;
+
+//bytes read from a text file at a time by the importers
+const std::size_t IMPORT_CHUNK_SIZE = 1 << 20;
+
+//first bytes of a file written by SaveBinary, the offsets are in bytes from the
+//start of the file. max_weight and total_weight are only informational, LoadBinary
+//works them out from the edges
+struct GraphFileHeader
+{
+    char magic[8];
+    unsigned version;
+    unsigned header_size;
+    unsigned node_count;
+    unsigned max_weight;
+    unsigned long long edge_count;
+    unsigned long long total_weight;
+    unsigned long long forward_offsets;
+    unsigned long long forward_edges;
+    unsigned long long reverse_offsets;
+    unsigned long long reverse_edges;
+    unsigned long long node_order;
+    unsigned long long file_size;
+};
+
+//a graph file opened by LoadBinary, the pointers point into the mapping
+struct MappedGraph
+{
+    MappedFile file;
+    const unsigned* offsets;
+    const AdjacencyInfo* edges;
+    const unsigned* reverse_offsets;
+    const AdjacencyInfo* reverse_edges;
+};
+
+    /*!
+      \brief
+      function to round a file offset up to the alignment of graph file arrays
+
+      \param offset
+      offset to round up
+
+      \return
+      returns the first aligned offset at or after offset
+    */
+    static unsigned long long AlignGraphOffset(unsigned long long offset) {
+        return (offset + GRAPH_FILE_ALIGNMENT - 1) / GRAPH_FILE_ALIGNMENT * GRAPH_FILE_ALIGNMENT;
+    }
+
+    /*!
+      \brief
+      function to read a number from a line of text, skipping spaces before it
+
+      \param cursor
+      where to start reading, moved past the number
+
+      \param end
+      end of the line
+
+      \param value
+      receives the number
+
+      \return
+      returns false if there is no number or it does not fit in an unsigned
+    */
+    static bool ParseUnsigned(const char*& cursor, const char* end, unsigned& value) {
+        while(cursor != end && (*cursor == ' ' || *cursor == '\t')){
+            ++cursor;
+        }
+        if(cursor == end || *cursor < '0' || *cursor > '9'){
+            return false;
+        }
+
+        unsigned long long number = 0;
+        while(cursor != end && *cursor >= '0' && *cursor <= '9'){
+            number = number * 10 + static_cast<unsigned>(*cursor - '0');
+            if(number > INFINITY_){
+                return false;
+            }
+            ++cursor;
+        }
+        value = static_cast<unsigned>(number);
+        return true;
+    }
+
+    /*!
+      \brief
+      function to check that only spaces are left on a line
+
+      \param cursor
+      where to start checking
+
+      \param end
+      end of the line
+
+      \return
+      returns true if the rest of the line is blank
+    */
+    static bool IsBlank(const char* cursor, const char* end) {
+        while(cursor != end){
+            if(*cursor != ' ' && *cursor != '\t' && *cursor != '\r'){
+                return false;
+            }
+            ++cursor;
+        }
+        return true;
+    }
+
+    /*!
+      \brief
+      function to get the index of the highest set bit of a number
+
+      \param value
+      number to check, must not be 0
+
+      \return
+      returns 0 for the lowest bit up to 31 for the highest
+    */
+    static unsigned HighestBit(unsigned value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 31 - static_cast<unsigned>(__builtin_clz(value));
+#else
+        unsigned bit = 0;
+        while(value >>= 1){
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+//barrier that threads spin on, delta stepping crosses one per phase and phases
+//are far too short to put threads to sleep in between
+class SpinBarrier
+{
+  public:
+    SpinBarrier(unsigned count) : waiting(0), generation(0), count(count) {
+    }
+
+    void Wait() {
+        unsigned int current_generation = generation.load();
+        if(waiting.fetch_add(1) + 1 == count){
+            waiting.store(0);
+            generation.fetch_add(1);
+            return;
+        }
+        while(generation.load() == current_generation){
+            std::this_thread::yield();
+        }
+    }
+
+  private:
+    std::atomic<unsigned> waiting;
+    std::atomic<unsigned> generation;
+    unsigned count;
+};
+
+//queue used by the original Dijkstra, a binary heap with check_greater_than
+struct BinaryHeapQueue
+{
+    std::vector<AdjacencyInfo>& heap;
+
+    BinaryHeapQueue(DijkstraWorkspace& workspace, unsigned) : heap(workspace.heap) {
+        heap.clear();
+    }
+
+    bool Empty() const {
+        return heap.empty();
+    }
+
+    void Push(unsigned node, unsigned cost) {
+        AdjacencyInfo info;
+        info.id = node;
+        info.weight = cost;
+        heap.push_back(info);
+        std::push_heap(heap.begin(), heap.end(), check_greater_than());
+    }
+
+    AdjacencyInfo Pop() {
+        std::pop_heap(heap.begin(), heap.end(), check_greater_than());
+        AdjacencyInfo top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+};
+
+//Dial's buckets, one per cost in a window of max weight + 1 costs starting at the
+//cost last taken out. every queued cost falls inside the window, so the bucket of a
+//cost is cost % bucket_count and each bucket only ever holds one cost at a time
+struct DialQueue
+{
+    std::vector<std::vector<AdjacencyInfo>>& buckets;
+    unsigned bucket_count;
+    unsigned cursor;
+    unsigned long long size;
+
+    DialQueue(DijkstraWorkspace& workspace, unsigned max_weight) : buckets(workspace.buckets),
+        bucket_count(max_weight + 1), cursor(0), size(0) {
+        if(buckets.size() < bucket_count){
+            buckets.resize(bucket_count);
+        }
+        for(unsigned int i=0; i < bucket_count; ++i){
+            buckets[i].clear();
+        }
+    }
+
+    bool Empty() const {
+        return size == 0;
+    }
+
+    void Push(unsigned node, unsigned cost) {
+        AdjacencyInfo info;
+        info.id = node;
+        info.weight = cost;
+        buckets[cost % bucket_count].push_back(info);
+        ++size;
+    }
+
+    AdjacencyInfo Pop() {
+        while(buckets[cursor % bucket_count].empty()){
+            ++cursor;
+        }
+        std::vector<AdjacencyInfo>& bucket = buckets[cursor % bucket_count];
+        AdjacencyInfo top = bucket.back();
+        bucket.pop_back();
+        --size;
+        return top;
+    }
+};
+
+//radix heap, bucket 0 holds the cost last taken out and bucket b + 1 the costs whose
+//highest bit that differs from it is b. a bucket is only split up again when
+//bucket 0 runs dry, so each entry moves at most 32 times
+struct RadixHeapQueue
+{
+    std::vector<std::vector<AdjacencyInfo>>& buckets;
+    unsigned last;
+    unsigned long long size;
+
+    RadixHeapQueue(DijkstraWorkspace& workspace, unsigned) : buckets(workspace.buckets), last(0), size(0) {
+        if(buckets.size() < RADIX_BUCKETS){
+            buckets.resize(RADIX_BUCKETS);
+        }
+        for(unsigned int i=0; i < RADIX_BUCKETS; ++i){
+            buckets[i].clear();
+        }
+    }
+
+    unsigned BucketOf(unsigned cost) const {
+        return cost == last ? 0 : HighestBit(cost ^ last) + 1;
+    }
+
+    bool Empty() const {
+        return size == 0;
+    }
+
+    void Push(unsigned node, unsigned cost) {
+        AdjacencyInfo info;
+        info.id = node;
+        info.weight = cost;
+        buckets[BucketOf(cost)].push_back(info);
+        ++size;
+    }
+
+    AdjacencyInfo Pop() {
+        if(buckets[0].empty()){
+            unsigned int i = 1;
+            while(buckets[i].empty()){
+                ++i;
+            }
+
+            //smallest cost of the first non empty bucket becomes last, which sends
+            //every entry of that bucket to a lower bucket
+            last = buckets[i].front().weight;
+            for(const AdjacencyInfo& info : buckets[i]){
+                last = std::min(last, info.weight);
+            }
+            for(const AdjacencyInfo& info : buckets[i]){
+                buckets[BucketOf(info.weight)].push_back(info);
+            }
+            buckets[i].clear();
+        }
+
+        AdjacencyInfo top = buckets[0].back();
+        buckets[0].pop_back();
+        --size;
+        return top;
+    }
+};
+
     /*!
       \brief
       deconstructor for ALGraph
@@ -24,8 +350,12 @@ const unsigned INFINITY_ = static_cast<unsigned>(-1);
     */
     ALGraph::~ALGraph(){
         total_num_of_nodes = 0;
-        src_to_node.clear();
         aList.clear();
+        csr_offsets.clear();
+        csr_edges.clear();
+        reverse_offsets.clear();
+        reverse_edges.clear();
+        mapped_graph.reset();
     }
 
     /*!
@@ -40,6 +370,12 @@ const unsigned INFINITY_ = static_cast<unsigned>(-1);
     */
     ALGraph::ALGraph(unsigned size){
         total_num_of_nodes = size;
+        bulk_loading = false;
+        frozen = false;
+        queue_strategy = QueueStrategy::BINARY_HEAP;
+        max_weight = 0;
+        total_weight = 0;
+        total_edges = 0;
 
         //allocate memory for all nodes in the graph
         for(unsigned int i=0; i < size; ++i){
@@ -56,9 +392,201 @@ const unsigned INFINITY_ = static_cast<unsigned>(-1);
       returns aList of type ALIST, which is a vector of vector of AdjacencyInfo
     */
     ALIST ALGraph::GetAList() const {
+        if(frozen || !external_id.empty()){
+            //lists go back to the ids the caller gave, in the same order
+            ALIST unpacked_list(total_num_of_nodes);
+            for(unsigned int i=0; i < total_num_of_nodes; ++i){
+                std::vector<AdjacencyInfo>& adjacency = unpacked_list[ToExternal(i+1)-1];
+                const AdjacencyInfo* first;
+                const AdjacencyInfo* last;
+                GetNeighbours(i+1, first, last);
+                adjacency.assign(first, last);
+                for(AdjacencyInfo& info : adjacency){
+                    info.id = ToExternal(info.id);
+                }
+            }
+            if(bulk_loading){
+                check_smaller_than smaller_than;
+                for(auto& adjacency : unpacked_list){
+                    std::stable_sort(adjacency.begin(), adjacency.end(), smaller_than);
+                }
+            }
+            return unpacked_list;
+        }
+
+        //lists are not kept sorted while bulk loading, hand out sorted copies
+        if(bulk_loading){
+            ALIST sorted_list = aList;
+            check_smaller_than smaller_than;
+            for(auto& adjacency : sorted_list){
+                std::stable_sort(adjacency.begin(), adjacency.end(), smaller_than);
+            }
+            return sorted_list;
+        }
         return aList;
     }
 
+    /*!
+      \brief
+      function to read the edges leaving a node without copying them
+
+      \param node
+      node to get the edges of
+
+      \return
+      returns a view of the edges, sorted like GetAList except while bulk loading
+    */
+    AdjacencyView ALGraph::GetAdjacency(unsigned node) const {
+        const AdjacencyInfo* first;
+        const AdjacencyInfo* last;
+        GetNeighbours(ToInternal(node), first, last);
+        return AdjacencyView(first, last, external_id.empty() ? nullptr : external_id.data());
+    }
+
+    /*!
+      \brief
+      function to read every adjacency list without copying them, use instead of
+      GetAList when the lists are only looked at
+
+      \return
+      returns a view indexed from 0 like ALIST
+    */
+    AListView ALGraph::GetAListView() const {
+        return AListView(*this);
+    }
+
+    /*!
+      \brief
+      function to get the number of nodes in the graph
+
+      \return
+      returns the number of nodes
+    */
+    unsigned ALGraph::GetNodeCount() const {
+        return total_num_of_nodes;
+    }
+
+    /*!
+      \brief
+      function to get the number of adjacency lists in the view
+
+      \return
+      returns the number of nodes of the graph
+    */
+    unsigned AListView::size() const {
+        return graph.GetNodeCount();
+    }
+
+    /*!
+      \brief
+      function to get the adjacency list of a node
+
+      \param index
+      node - 1, the same index as ALIST uses
+
+      \return
+      returns a view of the edges of the node
+    */
+    AdjacencyView AListView::operator[](unsigned index) const {
+        return graph.GetAdjacency(index + 1);
+    }
+
+    /*!
+      \brief
+      function to put one edge into the adjacency list of a node, in sorted
+      position, or at the back while bulk loading
+
+      \param node
+      node whose adjacency list gets the edge
+
+      \param info
+      the adjacent node and the weight of the edge
+
+      \return
+      none
+    */
+    void ALGraph::InsertAdjacency(unsigned node, const AdjacencyInfo& info) {
+        max_weight = std::max(max_weight, info.weight);
+        total_weight += info.weight;
+        ++total_edges;
+
+        //tracked trees keep the graph frozen for their repairs, thawing here would
+        //mean packing every edge again at the next UpdateEdgeWeight
+        if(frozen && !tracked_trees.empty()){
+            SpliceEdge(node, info);
+            for(DijkstraTree& tree : tracked_trees){
+                RepairDecrease(tree, node, info.id, info.weight);
+            }
+            return;
+        }
+
+        Thaw();
+        std::vector<AdjacencyInfo>& adjacency = aList[node-1];
+        if(bulk_loading){
+            adjacency.push_back(info);
+            for(DijkstraTree& tree : tracked_trees){
+                RepairDecrease(tree, node, info.id, info.weight);
+            }
+            return;
+        }
+
+        //the list is already sorted, so only this list needs to change.
+        //upper_bound keeps equal edges in the order they were added
+        check_smaller_original_id smaller_than = { external_id.empty() ? nullptr : external_id.data() };
+        adjacency.insert(std::upper_bound(adjacency.begin(), adjacency.end(), info, smaller_than), info);
+
+        //a new edge can only make paths cheaper
+        for(DijkstraTree& tree : tracked_trees){
+            RepairDecrease(tree, node, info.id, info.weight);
+        }
+    }
+
+    /*!
+      \brief
+      function to put one edge into the packed edges of a frozen graph, in the
+      position Freeze would have given it, and into the reverse edges. the edges
+      after it are moved along by one, which is far cheaper than packing every
+      edge again
+
+      \param node
+      node the edge starts from
+
+      \param info
+      the adjacent node and the weight of the edge
+
+      \return
+      none
+    */
+    void ALGraph::SpliceEdge(unsigned node, const AdjacencyInfo& info) {
+        OwnPackedEdges();
+
+        check_smaller_original_id smaller_than = { external_id.empty() ? nullptr : external_id.data() };
+        std::vector<AdjacencyInfo>::iterator first = csr_edges.begin() + csr_offsets[node-1];
+        std::vector<AdjacencyInfo>::iterator last = csr_edges.begin() + csr_offsets[node];
+        csr_edges.insert(std::upper_bound(first, last, info, smaller_than), info);
+        for(unsigned int i = node; i <= total_num_of_nodes; ++i){
+            ++csr_offsets[i];
+        }
+
+        //reverse edges are in the order of the ids the caller gave to the node they
+        //come from, parallel edges in the order of their weight as in the forward list
+        AdjacencyInfo reverse_edge;
+        reverse_edge.id = node;
+        reverse_edge.weight = info.weight;
+        const unsigned from = ToExternal(node);
+        std::vector<AdjacencyInfo>::iterator reverse_first = reverse_edges.begin() + reverse_offsets[info.id-1];
+        std::vector<AdjacencyInfo>::iterator reverse_last = reverse_edges.begin() + reverse_offsets[info.id];
+        std::vector<AdjacencyInfo>::iterator position = reverse_first;
+        while(position != reverse_last && (ToExternal(position->id) < from ||
+              (position->id == node && position->weight <= info.weight))){
+            ++position;
+        }
+        reverse_edges.insert(position, reverse_edge);
+        for(unsigned int i = info.id; i <= total_num_of_nodes; ++i){
+            ++reverse_offsets[i];
+        }
+    }
+
     /*!
       \brief
       function to add a directed edge between two nodes
@@ -77,17 +605,11 @@ const unsigned INFINITY_ = static_cast<unsigned>(-1);
     */
     void ALGraph::AddDEdge(unsigned source, unsigned destination, unsigned weight) {
         AdjacencyInfo info;
-        info.id = destination;
+        info.id = ToInternal(destination);
         info.weight = weight;
 
         //only store into node 1, not node 2
-        aList[source-1].push_back(info);
-
-        //sort each node's AdjacencyInfo by size
-        check_smaller_than smaller_than;
-        for(unsigned int i=0; i < aList.size(); ++i){
-            std::sort(aList[i].begin(), aList[i].end(), smaller_than);
-        }
+        InsertAdjacency(ToInternal(source), info);
     }
 
     /*!
@@ -108,97 +630,2189 @@ const unsigned INFINITY_ = static_cast<unsigned>(-1);
     */
     void ALGraph::AddUEdge(unsigned node1, unsigned node2, unsigned weight) {
         AdjacencyInfo info;
-        info.id = node2;
+        info.id = ToInternal(node2);
         info.weight = weight;
         //store into node 1
-        aList[node1-1].push_back(info);
+        InsertAdjacency(ToInternal(node1), info);
 
         AdjacencyInfo info2;
-        info2.id = node1;
+        info2.id = ToInternal(node1);
         info2.weight = weight;
 
         //store into node 2
-        aList[node2-1].push_back(info2);
+        InsertAdjacency(ToInternal(node2), info2);
+    }
 
-        //sort adjacency info for every node
-        check_smaller_than smaller_than;
-        for(unsigned int i=0; i < aList.size(); ++i){
-            std::sort(aList[i].begin(), aList[i].end(), smaller_than);
+    /*!
+      \brief
+      function to add many directed edges at once. every adjacency list is sorted
+      once after all the edges are in, instead of after every edge
+
+      \param edges
+      edges to add, source and destination as in AddDEdge
+
+      \return
+      none
+    */
+    void ALGraph::AddDEdges(const std::vector<EdgeInfo>& edges) {
+        //a frozen graph has no lists to reserve into yet
+        Thaw();
+
+        //count first so every list grows with a single allocation
+        std::vector<unsigned> degree(total_num_of_nodes, 0);
+        for(const EdgeInfo& edge : edges){
+            ++degree[ToInternal(edge.source)-1];
+        }
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            aList[i].reserve(aList[i].size() + degree[i]);
+        }
+
+        bool was_bulk_loading = bulk_loading;
+        bulk_loading = true;
+        for(const EdgeInfo& edge : edges){
+            AddDEdge(edge.source, edge.destination, edge.weight);
+        }
+        if(!was_bulk_loading){
+            EndBulkLoad();
         }
     }
 
     /*!
       \brief
-      function that implements Dijkstra algorithm to calculate all paths to every
-      node, starting from an arbitrary node
+      function to add many undirected edges at once. every adjacency list is sorted
+      once after all the edges are in, instead of after every edge
 
-      \param start_node
-      starting node for the algorithm
+      \param edges
+      edges to add, source and destination are the two nodes as in AddUEdge
 
       \return
-      returns a vector of DijkstraInfo, keeping track of the total cost of the path
-      as well as the nodes that the path consist of
+      none
     */
-    std::vector<DijkstraInfo> ALGraph::Dijkstra(unsigned start_node) const {
+    void ALGraph::AddUEdges(const std::vector<EdgeInfo>& edges) {
+        //a frozen graph has no lists to reserve into yet
+        Thaw();
 
-        //create vector of dist and previous
-        std::vector<int> dist(total_num_of_nodes, INFINITY_);
-        std::vector<int> previous(total_num_of_nodes, -1);
+        std::vector<unsigned> degree(total_num_of_nodes, 0);
+        for(const EdgeInfo& edge : edges){
+            ++degree[ToInternal(edge.source)-1];
+            ++degree[ToInternal(edge.destination)-1];
+        }
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            aList[i].reserve(aList[i].size() + degree[i]);
+        }
 
-        //distance to start node, from the start node, is 0
-        dist[start_node-1] = 0;
-        AdjacencyInfo info;
-        info.id = start_node;
-        info.weight = 0;
-        priority_queue.push(info);
+        bool was_bulk_loading = bulk_loading;
+        bulk_loading = true;
+        for(const EdgeInfo& edge : edges){
+            AddUEdge(edge.source, edge.destination, edge.weight);
+        }
+        if(!was_bulk_loading){
+            EndBulkLoad();
+        }
+    }
 
-        //while pq is not empty
-        while(!priority_queue.empty()){
-        unsigned int u = priority_queue.top().id;
+    /*!
+      \brief
+      function to start streaming edges in. until EndBulkLoad is called, AddDEdge
+      and AddUEdge only append to the adjacency lists without keeping them sorted
 
-            //extract the min, visit it
-            priority_queue.pop();
-            for(auto& neighbor : aList[u-1]){
-                unsigned int v = neighbor.id;
-                unsigned int weight = neighbor.weight;
+      \return
+      none
+    */
+    void ALGraph::BeginBulkLoad() {
+        Thaw();
+        bulk_loading = true;
+    }
 
-                //if distance to node +weight is lesser than current stored distance, replace it
-                if(dist[u-1] + weight < static_cast<unsigned>(dist[v-1])){
-                    dist[v-1] = dist[u-1] + weight;
-                    previous[v-1] = u;
-                    AdjacencyInfo info2;
-                    info2.id = v;
+    /*!
+      \brief
+      function to finish streaming edges in, sorts every adjacency list once
 
-                    //store into pq
-                    info2.weight = dist[v-1];
-                    priority_queue.push(info2);
-                }
-            }
+      \return
+      none
+    */
+    void ALGraph::EndBulkLoad() {
+        if(!bulk_loading){
+            return;
         }
+        bulk_loading = false;
 
-        //store finalized values in dist and previous into src_to_node map
-        for(unsigned int i=0; i < total_num_of_nodes; ++i){
-            src_to_node[i].cost = dist[i];
-                unsigned int curr_node =i;
+        //stable so equal edges stay in the order they were added, same as single inserts
+        check_smaller_original_id smaller_than = { external_id.empty() ? nullptr : external_id.data() };
+        for(unsigned int i=0; i < aList.size(); ++i){
+            std::stable_sort(aList[i].begin(), aList[i].end(), smaller_than);
+        }
+    }
 
-                //if previous node of current node is -1, break while loop
-                while(previous[curr_node] != (-1)){
-                    src_to_node[i].path.insert(src_to_node[i].path.begin(),previous[curr_node]);
-                    curr_node = previous[curr_node]-1;
-                }
+    /*!
+      \brief
+      function to compile the adjacency lists into compressed sparse row form,
+      one offsets array and one packed array of every edge. the lists are freed,
+      Dijkstra and GetAList read the packed edges instead. adding an edge or
+      starting a bulk load thaws the graph back into lists
 
-                //if distance to node is not equal to -1, push back
-                if(dist[i] != (-1)){
-                    src_to_node[i].path.push_back(i+1);
-                }
+      \return
+      none
+    */
+    void ALGraph::Freeze() {
+        if(frozen){
+            return;
+        }
+        //lists must be sorted before they are packed
+        EndBulkLoad();
 
+        csr_offsets.assign(total_num_of_nodes + 1, 0);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            csr_offsets[i+1] = csr_offsets[i] + static_cast<unsigned>(aList[i].size());
         }
 
-        //convert to vector only for the start node, and return
-        std::vector<DijkstraInfo> tmp;
-        for(unsigned int i=0; i < total_num_of_nodes;++i){
-            tmp.push_back(src_to_node[i]);
+        csr_edges.clear();
+        csr_edges.reserve(csr_offsets[total_num_of_nodes]);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            csr_edges.insert(csr_edges.end(), aList[i].begin(), aList[i].end());
         }
-        return tmp;
-    }
 
+        //reverse edges, so searches can also run backwards from a target. id is the
+        //node the edge comes from
+        reverse_offsets.assign(total_num_of_nodes + 1, 0);
+        for(const AdjacencyInfo& edge : csr_edges){
+            ++reverse_offsets[edge.id];
+        }
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            reverse_offsets[i+1] += reverse_offsets[i];
+        }
+        reverse_edges.resize(csr_edges.size());
+        //filled in the order of the ids the caller gave, so reordering does not
+        //change the order of the reverse edges either
+        std::vector<unsigned> next_slot(reverse_offsets.begin(), reverse_offsets.end() - 1);
+        for(unsigned int node=1; node <= total_num_of_nodes; ++node){
+            unsigned int i = ToInternal(node) - 1;
+            for(unsigned int e = csr_offsets[i]; e < csr_offsets[i+1]; ++e){
+                AdjacencyInfo reverse_edge;
+                reverse_edge.id = i+1;
+                reverse_edge.weight = csr_edges[e].weight;
+                reverse_edges[next_slot[csr_edges[e].id-1]++] = reverse_edge;
+            }
+        }
+
+        //swap with an empty list so the memory of every list is actually released
+        ALIST().swap(aList);
+        frozen = true;
+    }
+
+    /*!
+      \brief
+      function to turn the packed edges back into adjacency lists
+
+      \return
+      none
+    */
+    void ALGraph::Thaw() {
+        if(!frozen){
+            return;
+        }
+
+        //unpacked in the ids inside the graph, GetAList would hand out the ids the caller gave
+        aList.assign(total_num_of_nodes, std::vector<AdjacencyInfo>());
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            aList[i].assign(CsrEdges() + CsrOffsets()[i], CsrEdges() + CsrOffsets()[i+1]);
+        }
+        std::vector<unsigned>().swap(csr_offsets);
+        std::vector<AdjacencyInfo>().swap(csr_edges);
+        std::vector<unsigned>().swap(reverse_offsets);
+        std::vector<AdjacencyInfo>().swap(reverse_edges);
+        mapped_graph.reset();
+        frozen = false;
+    }
+
+    /*!
+      \brief
+      function to check if the graph is in compressed sparse row form
+
+      \return
+      returns true if Freeze was called and the graph has not been thawed since
+    */
+    bool ALGraph::IsFrozen() const {
+        return frozen;
+    }
+
+    /*!
+      \brief
+      function to write the graph to a binary file that LoadBinary can map back
+      in without parsing. the file holds a versioned header and the packed
+      forward and reverse edges of Freeze, in the byte order of this machine.
+      a graph that is not frozen is packed into a copy first
+
+      \param filename
+      name of the file to write, replaced only once it is written completely
+
+      \return
+      returns false if the file could not be written
+    */
+    bool ALGraph::SaveBinary(const char* filename) const {
+        if(!frozen){
+            ALGraph packed(*this);
+            packed.Freeze();
+            return packed.SaveBinary(filename);
+        }
+
+        const unsigned long long offsets_size = (total_num_of_nodes + 1ull) * sizeof(unsigned);
+        const unsigned long long edge_count = CsrOffsets()[total_num_of_nodes];
+        const unsigned long long edges_size = edge_count * sizeof(AdjacencyInfo);
+
+        GraphFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+        header.version = GRAPH_FILE_VERSION;
+        header.header_size = sizeof(GraphFileHeader);
+        header.node_count = total_num_of_nodes;
+        header.max_weight = max_weight;
+        header.edge_count = edge_count;
+        header.total_weight = total_weight;
+        header.forward_offsets = AlignGraphOffset(sizeof(GraphFileHeader));
+        header.forward_edges = AlignGraphOffset(header.forward_offsets + offsets_size);
+        header.reverse_offsets = AlignGraphOffset(header.forward_edges + edges_size);
+        header.reverse_edges = AlignGraphOffset(header.reverse_offsets + offsets_size);
+        header.file_size = header.reverse_edges + edges_size;
+        if(!external_id.empty()){
+            header.node_order = AlignGraphOffset(header.file_size);
+            header.file_size = header.node_order + total_num_of_nodes * sizeof(unsigned);
+        }
+
+        //written to a temporary file first so a failed save never leaves half a graph behind
+        const std::string path(filename);
+        const std::string temporary_path = path + ".tmp";
+        {
+            std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+            if(!out){
+                return false;
+            }
+
+            auto pad_to = [&out](unsigned long long offset) {
+                static const char zeros[GRAPH_FILE_ALIGNMENT] = {};
+                unsigned long long position = static_cast<unsigned long long>(out.tellp());
+                out.write(zeros, static_cast<std::streamsize>(offset - position));
+            };
+
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            pad_to(header.forward_offsets);
+            out.write(reinterpret_cast<const char*>(CsrOffsets()), static_cast<std::streamsize>(offsets_size));
+            pad_to(header.forward_edges);
+            out.write(reinterpret_cast<const char*>(CsrEdges()), static_cast<std::streamsize>(edges_size));
+            pad_to(header.reverse_offsets);
+            out.write(reinterpret_cast<const char*>(ReverseOffsets()), static_cast<std::streamsize>(offsets_size));
+            pad_to(header.reverse_edges);
+            out.write(reinterpret_cast<const char*>(ReverseEdges()), static_cast<std::streamsize>(edges_size));
+            if(header.node_order){
+                pad_to(header.node_order);
+                out.write(reinterpret_cast<const char*>(external_id.data()),
+                          static_cast<std::streamsize>(total_num_of_nodes * sizeof(unsigned)));
+            }
+
+            if(!out){
+                out.close();
+                std::remove(temporary_path.c_str());
+                return false;
+            }
+        }
+
+        std::remove(path.c_str());
+        if(std::rename(temporary_path.c_str(), path.c_str()) != 0){
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /*!
+      \brief
+      function to replace the graph with one written by SaveBinary. the file is
+      memory mapped and the graph is frozen on the mapped edges, so nothing is
+      copied and pages are only read in when a search touches them. the file
+      must not be changed while the graph, or a copy of it, is still in use
+
+      \param filename
+      name of the file to open
+
+      \return
+      returns false, leaving the graph as it was, if the file cannot be mapped, is
+      not a graph file of this version, or has offsets or edges that do not fit
+      the nodes and edges it says it holds
+    */
+    bool ALGraph::LoadBinary(const char* filename) {
+        std::shared_ptr<MappedGraph> graph_file = std::make_shared<MappedGraph>();
+        if(!graph_file->file.open(filename) || graph_file->file.size() < sizeof(GraphFileHeader)){
+            return false;
+        }
+
+        const unsigned char* bytes = graph_file->file.data();
+        GraphFileHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if(std::memcmp(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+           header.version != GRAPH_FILE_VERSION || header.header_size != sizeof(GraphFileHeader) ||
+           header.file_size != graph_file->file.size()){
+            return false;
+        }
+
+        //every array has to lie inside the file where the header says it is
+        const unsigned long long offsets_size = (header.node_count + 1ull) * sizeof(unsigned);
+        const unsigned long long edges_size = header.edge_count * sizeof(AdjacencyInfo);
+        if(header.forward_offsets != AlignGraphOffset(sizeof(GraphFileHeader)) ||
+           header.forward_edges != AlignGraphOffset(header.forward_offsets + offsets_size) ||
+           header.reverse_offsets != AlignGraphOffset(header.forward_edges + edges_size) ||
+           header.reverse_edges != AlignGraphOffset(header.reverse_offsets + offsets_size)){
+            return false;
+        }
+        if(header.node_order ? header.node_order != AlignGraphOffset(header.reverse_edges + edges_size) ||
+                               header.file_size != header.node_order + header.node_count * sizeof(unsigned)
+                             : header.file_size != header.reverse_edges + edges_size){
+            return false;
+        }
+
+        graph_file->offsets = reinterpret_cast<const unsigned*>(bytes + header.forward_offsets);
+        graph_file->edges = reinterpret_cast<const AdjacencyInfo*>(bytes + header.forward_edges);
+        graph_file->reverse_offsets = reinterpret_cast<const unsigned*>(bytes + header.reverse_offsets);
+        graph_file->reverse_edges = reinterpret_cast<const AdjacencyInfo*>(bytes + header.reverse_edges);
+        if(graph_file->offsets[0] != 0 || graph_file->offsets[header.node_count] != header.edge_count ||
+           graph_file->reverse_offsets[0] != 0 || graph_file->reverse_offsets[header.node_count] != header.edge_count){
+            return false;
+        }
+
+        //searches index straight into the arrays, so one pass makes sure every list
+        //lies inside the edges and every edge leads to a node of the graph. the weight
+        //totals are taken from the edges too, the queues and DeltaStepping size their
+        //buckets from max_weight
+        for(unsigned int i=0; i < header.node_count; ++i){
+            if(graph_file->offsets[i] > graph_file->offsets[i+1] ||
+               graph_file->reverse_offsets[i] > graph_file->reverse_offsets[i+1]){
+                return false;
+            }
+        }
+        unsigned file_max_weight = 0;
+        unsigned long long file_total_weight = 0;
+        for(unsigned long long i=0; i < header.edge_count; ++i){
+            unsigned id = graph_file->edges[i].id;
+            unsigned reverse_id = graph_file->reverse_edges[i].id;
+            if(id == 0 || id > header.node_count || reverse_id == 0 || reverse_id > header.node_count){
+                return false;
+            }
+            file_max_weight = std::max(file_max_weight, graph_file->edges[i].weight);
+            file_total_weight += graph_file->edges[i].weight;
+        }
+
+        //the order of a reordered graph is copied out, both directions are needed
+        std::vector<unsigned> file_external_id;
+        std::vector<unsigned> file_internal_id;
+        if(header.node_order){
+            const unsigned* order = reinterpret_cast<const unsigned*>(bytes + header.node_order);
+            file_external_id.assign(order, order + header.node_count);
+            file_internal_id.assign(header.node_count, 0);
+            for(unsigned int i=0; i < header.node_count; ++i){
+                unsigned node = file_external_id[i];
+                if(node == 0 || node > header.node_count || file_internal_id[node-1] != 0){
+                    return false;
+                }
+                file_internal_id[node-1] = i+1;
+            }
+        }
+
+        ALIST().swap(aList);
+        std::vector<unsigned>().swap(csr_offsets);
+        std::vector<AdjacencyInfo>().swap(csr_edges);
+        std::vector<unsigned>().swap(reverse_offsets);
+        std::vector<AdjacencyInfo>().swap(reverse_edges);
+        mapped_graph = graph_file;
+        external_id.swap(file_external_id);
+        internal_id.swap(file_internal_id);
+
+        total_num_of_nodes = header.node_count;
+        max_weight = file_max_weight;
+        total_weight = file_total_weight;
+        total_edges = header.edge_count;
+        bulk_loading = false;
+        frozen = true;
+
+        //a different graph, the trees of sources that still exist are searched again
+        std::vector<DijkstraTree> old_trees;
+        old_trees.swap(tracked_trees);
+        for(const DijkstraTree& tree : old_trees){
+            if(tree.source <= total_num_of_nodes){
+                tracked_trees.push_back(ShortestPathTree(tree.source));
+            }
+        }
+        return true;
+    }
+
+    /*!
+      \brief
+      function to renumber the nodes inside the graph so that nodes joined by an
+      edge sit close together in memory, and searches jump around less. every
+      function still takes and returns the ids the caller gave, including the
+      paths, views and workspaces. a frozen graph is frozen again afterwards,
+      and a bulk load is finished first
+
+      \param order
+      order to number the nodes in, ORIGINAL undoes any earlier reordering
+
+      \return
+      none
+    */
+    void ALGraph::Reorder(NodeOrder order) {
+        std::vector<unsigned> sequence;
+        sequence.reserve(total_num_of_nodes);
+        if(order == NodeOrder::ORIGINAL){
+            for(unsigned int node=1; node <= total_num_of_nodes; ++node){
+                sequence.push_back(ToInternal(node));
+            }
+            ApplyOrder(sequence);
+            return;
+        }
+
+        //edges are followed both ways, so a directed graph is ordered by what is
+        //close to a node whichever way the edges point
+        std::vector<unsigned> offsets(total_num_of_nodes + 1, 0);
+        for(unsigned int u=1; u <= total_num_of_nodes; ++u){
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* edge = first; edge != last; ++edge){
+                ++offsets[u];
+                ++offsets[edge->id];
+            }
+        }
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            offsets[i+1] += offsets[i];
+        }
+        std::vector<unsigned> neighbours(offsets[total_num_of_nodes]);
+        std::vector<unsigned> next_slot(offsets.begin(), offsets.end() - 1);
+        for(unsigned int u=1; u <= total_num_of_nodes; ++u){
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* edge = first; edge != last; ++edge){
+                neighbours[next_slot[u-1]++] = edge->id;
+                neighbours[next_slot[edge->id-1]++] = u;
+            }
+        }
+        auto degree = [&offsets](unsigned node) {
+            return offsets[node] - offsets[node-1];
+        };
+
+        //every part of the graph starts from the first node not reached yet, in the
+        //order of the ids the caller gave, or from the lowest degree one for
+        //Cuthill-McKee
+        std::vector<unsigned> starts;
+        starts.reserve(total_num_of_nodes);
+        for(unsigned int node=1; node <= total_num_of_nodes; ++node){
+            starts.push_back(ToInternal(node));
+        }
+        const bool cuthill_mckee = order == NodeOrder::REVERSE_CUTHILL_MCKEE;
+        if(cuthill_mckee){
+            std::stable_sort(starts.begin(), starts.end(), [&degree](unsigned lhs, unsigned rhs) {
+                return degree(lhs) < degree(rhs);
+            });
+        }
+
+        std::vector<bool> visited(total_num_of_nodes, false);
+        for(unsigned start : starts){
+            if(visited[start-1]){
+                continue;
+            }
+            visited[start-1] = true;
+            sequence.push_back(start);
+
+            //sequence doubles as the queue, nodes of this part start at head
+            for(std::size_t head = sequence.size() - 1; head < sequence.size(); ++head){
+                unsigned u = sequence[head];
+                std::size_t first_new = sequence.size();
+                for(unsigned int e = offsets[u-1]; e < offsets[u]; ++e){
+                    unsigned v = neighbours[e];
+                    if(!visited[v-1]){
+                        visited[v-1] = true;
+                        sequence.push_back(v);
+                    }
+                }
+                if(cuthill_mckee){
+                    std::stable_sort(sequence.begin() + first_new, sequence.end(), [&degree](unsigned lhs, unsigned rhs) {
+                        return degree(lhs) < degree(rhs);
+                    });
+                }
+            }
+        }
+
+        if(cuthill_mckee){
+            std::reverse(sequence.begin(), sequence.end());
+        }
+        ApplyOrder(sequence);
+    }
+
+    /*!
+      \brief
+      function to renumber the nodes inside the graph along a Hilbert curve
+      through their positions, so nodes close together in space are close
+      together in memory. works like Reorder otherwise
+
+      \param positions
+      position of every node, positions[node - 1]
+
+      \return
+      returns false, leaving the graph as it was, if there is not exactly one
+      position per node
+    */
+    bool ALGraph::ReorderByPosition(const std::vector<NodePosition>& positions) {
+        if(positions.size() != total_num_of_nodes){
+            return false;
+        }
+        if(total_num_of_nodes == 0){
+            return true;
+        }
+
+        float min_x = positions[0].x, max_x = positions[0].x;
+        float min_y = positions[0].y, max_y = positions[0].y;
+        for(const NodePosition& position : positions){
+            min_x = std::min(min_x, position.x);
+            max_x = std::max(max_x, position.x);
+            min_y = std::min(min_y, position.y);
+            max_y = std::max(max_y, position.y);
+        }
+
+        //positions are snapped to a 65536 by 65536 grid, and the distance along the
+        //curve is worked out from the top bit down
+        const unsigned GRID_BITS = 16;
+        const double grid_max = (1u << GRID_BITS) - 1;
+        const double scale_x = max_x > min_x ? grid_max / (static_cast<double>(max_x) - min_x) : 0.0;
+        const double scale_y = max_y > min_y ? grid_max / (static_cast<double>(max_y) - min_y) : 0.0;
+
+        std::vector<AdjacencyInfo> keys(total_num_of_nodes);
+        for(unsigned int node=1; node <= total_num_of_nodes; ++node){
+            unsigned x = static_cast<unsigned>((positions[node-1].x - min_x) * scale_x);
+            unsigned y = static_cast<unsigned>((positions[node-1].y - min_y) * scale_y);
+            unsigned distance = 0;
+            for(unsigned side = 1u << (GRID_BITS - 1); side > 0; side >>= 1){
+                unsigned rx = (x & side) ? 1 : 0;
+                unsigned ry = (y & side) ? 1 : 0;
+                distance += side * side * ((3 * rx) ^ ry);
+
+                //turn the quadrant so the curve inside it starts where the last one ended
+                if(ry == 0){
+                    if(rx == 1){
+                        x = side - 1 - (x & (side - 1));
+                        y = side - 1 - (y & (side - 1));
+                    }
+                    std::swap(x, y);
+                }
+            }
+            keys[node-1].id = ToInternal(node);
+            keys[node-1].weight = distance;
+        }
+
+        //ties keep the order of the ids the caller gave
+        std::stable_sort(keys.begin(), keys.end(), [](const AdjacencyInfo& lhs, const AdjacencyInfo& rhs) {
+            return lhs.weight < rhs.weight;
+        });
+        std::vector<unsigned> sequence(total_num_of_nodes);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            sequence[i] = keys[i].id;
+        }
+        ApplyOrder(sequence);
+        return true;
+    }
+
+    /*!
+      \brief
+      function to renumber the nodes, keeping every adjacency list in the same
+      order so results do not change
+
+      \param sequence
+      current ids of the nodes, in the order they get their new ids
+
+      \return
+      none
+    */
+    void ALGraph::ApplyOrder(const std::vector<unsigned>& sequence) {
+        const bool was_frozen = frozen;
+        EndBulkLoad();
+        Thaw();
+
+        std::vector<unsigned> new_id(total_num_of_nodes);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            new_id[sequence[i]-1] = i+1;
+        }
+
+        //lists are sorted by weight and the ids the caller gave, neither changes here
+        ALIST new_list(total_num_of_nodes);
+        std::vector<unsigned> new_external_id(total_num_of_nodes);
+        bool original_order = true;
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            new_list[i].swap(aList[sequence[i]-1]);
+            for(AdjacencyInfo& info : new_list[i]){
+                info.id = new_id[info.id-1];
+            }
+            new_external_id[i] = ToExternal(sequence[i]);
+            original_order = original_order && new_external_id[i] == i+1;
+        }
+        aList.swap(new_list);
+
+        if(original_order){
+            std::vector<unsigned>().swap(internal_id);
+            std::vector<unsigned>().swap(external_id);
+        }
+        else{
+            internal_id.resize(total_num_of_nodes);
+            for(unsigned int i=0; i < total_num_of_nodes; ++i){
+                internal_id[new_external_id[i]-1] = i+1;
+            }
+            external_id.swap(new_external_id);
+        }
+
+        if(was_frozen){
+            Freeze();
+        }
+    }
+
+    /*!
+      \brief
+      function to change the weight of an edge in place, keeping the adjacency
+      list sorted. a frozen graph stays frozen, and a graph with tracked sources
+      is frozen first. the shortest path tree of every tracked source is
+      repaired, only the nodes whose cost can change are looked at instead of
+      running Dijkstra again. an undirected edge is two directed edges, change both
+
+      \param source
+      node that the edge starts from
+
+      \param destination
+      node that the edge is moving towards
+
+      \param weight
+      new weight of the edge, every parallel edge gets it
+
+      \return
+      returns false if there is no edge from source to destination
+    */
+    bool ALGraph::UpdateEdgeWeight(unsigned source, unsigned destination, unsigned weight) {
+        source = ToInternal(source);
+        destination = ToInternal(destination);
+
+        //repairs after a weight goes up need the reverse edges
+        if(!tracked_trees.empty()){
+            Freeze();
+        }
+        if(frozen){
+            OwnPackedEdges();
+        }
+
+        AdjacencyInfo* first;
+        AdjacencyInfo* last;
+        if(frozen){
+            first = csr_edges.data() + csr_offsets[source-1];
+            last = csr_edges.data() + csr_offsets[source];
+        }
+        else{
+            first = aList[source-1].data();
+            last = first + aList[source-1].size();
+        }
+
+        //parallel edges all change, the cheapest of them is the edge searches used
+        unsigned old_weight = INFINITY_;
+        for(AdjacencyInfo* edge = first; edge != last; ++edge){
+            if(edge->id == destination){
+                old_weight = std::min(old_weight, edge->weight);
+                total_weight += weight;
+                total_weight -= edge->weight;
+                edge->weight = weight;
+            }
+        }
+        if(old_weight == INFINITY_){
+            return false;
+        }
+        max_weight = std::max(max_weight, weight);
+
+        //only the changed edges are out of place, so insertion sort moves just them.
+        //a list that is still being bulk loaded is sorted at the end anyway
+        if(!bulk_loading){
+            check_smaller_original_id smaller_than = { external_id.empty() ? nullptr : external_id.data() };
+            for(AdjacencyInfo* edge = first + 1; edge < last; ++edge){
+                for(AdjacencyInfo* curr = edge; curr != first && smaller_than(*curr, *(curr - 1)); --curr){
+                    std::swap(*curr, *(curr - 1));
+                }
+            }
+        }
+
+        //reverse edges are in the order of the node they come from, nothing moves
+        if(frozen){
+            for(unsigned int e = reverse_offsets[destination-1]; e < reverse_offsets[destination]; ++e){
+                if(reverse_edges[e].id == source){
+                    reverse_edges[e].weight = weight;
+                }
+            }
+        }
+
+        for(DijkstraTree& tree : tracked_trees){
+            if(weight < old_weight){
+                RepairDecrease(tree, source, destination, weight);
+                continue;
+            }
+
+            //only a tree edge going up can change any cost
+            unsigned from_cost = tree.cost[ToExternal(source)-1];
+            if(weight > old_weight && from_cost != INFINITY_ &&
+               tree.previous[ToExternal(destination)-1] == ToExternal(source) &&
+               tree.cost[ToExternal(destination)-1] == from_cost + old_weight){
+                RepairIncrease(tree, destination);
+            }
+        }
+        return true;
+    }
+
+    /*!
+      \brief
+      function to keep a shortest path tree from a node up to date while edges
+      are added and weights change. the graph is frozen, since repairing the tree
+      after a weight goes up needs the edges coming into a node. while a source is
+      tracked AddDEdge and AddUEdge splice into the frozen graph, which moves the
+      edges after the new one along, a memory move over the edges per edge added.
+      AddDEdges, AddUEdges, BeginBulkLoad and new nodes still thaw the graph, and
+      the next UpdateEdgeWeight packs every edge again, so add edges in batches
+
+      \param source
+      node the tree starts from, tracking it again does nothing
+
+      \return
+      none
+    */
+    void ALGraph::TrackSource(unsigned source) {
+        if(GetTrackedTree(source)){
+            return;
+        }
+        Freeze();
+        tracked_trees.push_back(ShortestPathTree(source));
+    }
+
+    /*!
+      \brief
+      function to stop keeping the shortest path tree of a node
+
+      \param source
+      node given to TrackSource
+
+      \return
+      none
+    */
+    void ALGraph::UntrackSource(unsigned source) {
+        for(unsigned int i=0; i < tracked_trees.size(); ++i){
+            if(tracked_trees[i].source == source){
+                tracked_trees.erase(tracked_trees.begin() + i);
+                return;
+            }
+        }
+    }
+
+    /*!
+      \brief
+      function to get the shortest path tree kept for a node. equal cost paths
+      may differ from the ones a new Dijkstra search would pick
+
+      \param source
+      node given to TrackSource
+
+      \return
+      returns the tree, valid until the graph is changed, nullptr if source is
+      not tracked
+    */
+    const DijkstraTree* ALGraph::GetTrackedTree(unsigned source) const {
+        for(const DijkstraTree& tree : tracked_trees){
+            if(tree.source == source){
+                return &tree;
+            }
+        }
+        return nullptr;
+    }
+
+    /*!
+      \brief
+      function to add nodes until the graph has at least node_count of them
+
+      \param node_count
+      number of nodes the graph needs
+
+      \return
+      none
+    */
+    void ALGraph::GrowTo(unsigned node_count) {
+        if(node_count <= total_num_of_nodes){
+            return;
+        }
+        Thaw();
+        aList.resize(node_count);
+
+        //new nodes keep their own ids in a reordered graph
+        for(unsigned int node = total_num_of_nodes + 1; !external_id.empty() && node <= node_count; ++node){
+            internal_id.push_back(node);
+            external_id.push_back(node);
+        }
+        total_num_of_nodes = node_count;
+        for(DijkstraTree& tree : tracked_trees){
+            tree.cost.resize(node_count, INFINITY_);
+            tree.previous.resize(node_count, 0);
+        }
+    }
+
+    /*!
+      \brief
+      function to read a text file in chunks and hand every line to a parser,
+      inside a bulk load
+
+      \param filename
+      name of the file to read
+
+      \param parse_line
+      called with the start and end of each line, returns false on a bad line
+
+      \return
+      returns false if the file cannot be read or parse_line returns false
+    */
+    template <typename LineParser>
+    bool ALGraph::ImportLines(const char* filename, LineParser parse_line) {
+        std::FILE* file = std::fopen(filename, "rb");
+        if(!file){
+            return false;
+        }
+
+        //a bulk load the caller already started is left running
+        const bool was_bulk_loading = bulk_loading;
+        BeginBulkLoad();
+
+        //the end of a chunk is usually part of a line, it is moved to the front and
+        //finished by the next chunk
+        std::vector<char> buffer(IMPORT_CHUNK_SIZE);
+        std::size_t carried = 0;
+        bool parsed = true;
+        while(parsed){
+            std::size_t read = std::fread(buffer.data() + carried, 1, buffer.size() - carried, file);
+            const char* line = buffer.data();
+            const char* end = buffer.data() + carried + read;
+
+            const char* newline;
+            while(parsed && (newline = static_cast<const char*>(std::memchr(line, '\n', end - line)))){
+                parsed = parse_line(line, newline);
+                line = newline + 1;
+            }
+            if(!parsed){
+                break;
+            }
+
+            if(read == 0){
+                //the last line does not need to end with a newline
+                parsed = !std::ferror(file) && (line == end || parse_line(line, end));
+                break;
+            }
+
+            carried = static_cast<std::size_t>(end - line);
+            std::memmove(buffer.data(), line, carried);
+            if(carried == buffer.size()){
+                buffer.resize(buffer.size() * 2);
+            }
+        }
+
+        std::fclose(file);
+        if(!was_bulk_loading){
+            EndBulkLoad();
+        }
+        return parsed;
+    }
+
+    /*!
+      \brief
+      function to add the arcs of a DIMACS shortest path file, "p sp n m" then
+      one "a u v w" line per directed arc, "c" lines are comments. the file is
+      read in chunks and the edges are bulk loaded, so memory does not grow with
+      the size of the text
+
+      \param filename
+      name of the file to read
+
+      \return
+      returns false if the file cannot be read or a line cannot be parsed, the
+      edges before the bad line are kept
+    */
+    bool ALGraph::ImportDimacs(const char* filename) {
+        bool seen_problem = false;
+        return ImportLines(filename, [this, &seen_problem](const char* cursor, const char* end) {
+            if(IsBlank(cursor, end) || *cursor == 'c'){
+                return true;
+            }
+
+            unsigned source, destination, weight;
+            if(*cursor == 'p'){
+                //"p sp nodes arcs", the arc count is only a hint
+                ++cursor;
+                while(cursor != end && (*cursor == ' ' || *cursor == '\t')){
+                    ++cursor;
+                }
+                if(end - cursor < 2 || cursor[0] != 's' || cursor[1] != 'p'){
+                    return false;
+                }
+                cursor += 2;
+                unsigned node_count, arc_count;
+                if(seen_problem || !ParseUnsigned(cursor, end, node_count) ||
+                   !ParseUnsigned(cursor, end, arc_count) || !IsBlank(cursor, end)){
+                    return false;
+                }
+                seen_problem = true;
+                GrowTo(node_count);
+                return true;
+            }
+            if(*cursor != 'a' || !seen_problem){
+                return false;
+            }
+
+            ++cursor;
+            if(!ParseUnsigned(cursor, end, source) || !ParseUnsigned(cursor, end, destination) ||
+               !ParseUnsigned(cursor, end, weight) || !IsBlank(cursor, end)){
+                return false;
+            }
+            if(source == 0 || destination == 0 || source > total_num_of_nodes || destination > total_num_of_nodes){
+                return false;
+            }
+            AddDEdge(source, destination, weight);
+            return true;
+        });
+    }
+
+    /*!
+      \brief
+      function to add the edges of a text edge list, one "u v" or "u v w" line
+      per edge with node ids from 1, weight 1 when it is left out. lines starting
+      with '#' or '%' are comments. nodes are added when an id is past the last
+      node
+
+      \param filename
+      name of the file to read
+
+      \param undirected
+      true to add every edge in both directions
+
+      \return
+      returns false if the file cannot be read or a line cannot be parsed, the
+      edges before the bad line are kept
+    */
+    bool ALGraph::ImportEdgeList(const char* filename, bool undirected) {
+        return ImportLines(filename, [this, undirected](const char* cursor, const char* end) {
+            if(IsBlank(cursor, end)){
+                return true;
+            }
+            const char* first = cursor;
+            while(first != end && (*first == ' ' || *first == '\t')){
+                ++first;
+            }
+            if(*first == '#' || *first == '%'){
+                return true;
+            }
+
+            unsigned source, destination;
+            unsigned weight = 1;
+            if(!ParseUnsigned(cursor, end, source) || !ParseUnsigned(cursor, end, destination)){
+                return false;
+            }
+            if(!IsBlank(cursor, end) && (!ParseUnsigned(cursor, end, weight) || !IsBlank(cursor, end))){
+                return false;
+            }
+            if(source == 0 || destination == 0){
+                return false;
+            }
+
+            GrowTo(std::max(source, destination));
+            if(undirected){
+                AddUEdge(source, destination, weight);
+            }
+            else{
+                AddDEdge(source, destination, weight);
+            }
+            return true;
+        });
+    }
+
+
+    /*!
+      \brief
+      function to choose the priority queue that Dijkstra, ShortestPath and
+      Reachable use. BidirectionalShortestPath always uses the binary heap.
+      every queue gives the same costs, but DIAL, RADIX_HEAP and AUTO can pick a
+      different path among paths of equal cost than the binary heap does
+
+      \param strategy
+      queue to use, BINARY_HEAP by default
+
+      \return
+      none
+    */
+    void ALGraph::SetQueueStrategy(QueueStrategy strategy) {
+        queue_strategy = strategy;
+    }
+
+    /*!
+      \brief
+      function to get the priority queue the searches will use, with AUTO
+      already resolved from the largest edge weight
+
+      \return
+      returns BINARY_HEAP, DIAL or RADIX_HEAP
+    */
+    QueueStrategy ALGraph::GetQueueStrategy() const {
+        switch(queue_strategy){
+            case QueueStrategy::AUTO:
+                return max_weight <= DIAL_AUTO_MAX_WEIGHT ? QueueStrategy::DIAL : QueueStrategy::RADIX_HEAP;
+            case QueueStrategy::DIAL:
+                return max_weight <= DIAL_MAX_WEIGHT ? QueueStrategy::DIAL : QueueStrategy::RADIX_HEAP;
+            default:
+                return queue_strategy;
+        }
+    }
+
+    /*!
+      \brief
+      function to get the edges leaving a node, from whichever storage is in use
+
+      \param node
+      node to get the edges of
+
+      \param first
+      set to the first edge of the node
+
+      \param last
+      set to one past the last edge of the node
+
+      \return
+      none
+    */
+    void ALGraph::GetNeighbours(unsigned node, const AdjacencyInfo*& first, const AdjacencyInfo*& last) const {
+        if(frozen){
+            first = CsrEdges() + CsrOffsets()[node-1];
+            last = CsrEdges() + CsrOffsets()[node];
+        }
+        else{
+            first = aList[node-1].data();
+            last = first + aList[node-1].size();
+        }
+    }
+
+    /*!
+      \brief
+      function to get the edges coming into a node, only valid while frozen
+
+      \param node
+      node to get the incoming edges of
+
+      \param first
+      set to the first incoming edge, its id is the node the edge comes from
+
+      \param last
+      set to one past the last incoming edge
+
+      \return
+      none
+    */
+    void ALGraph::GetReverseNeighbours(unsigned node, const AdjacencyInfo*& first, const AdjacencyInfo*& last) const {
+        first = ReverseEdges() + ReverseOffsets()[node-1];
+        last = ReverseEdges() + ReverseOffsets()[node];
+    }
+
+    //packed arrays of the frozen graph, from the mapped file if LoadBinary was used
+    const unsigned* ALGraph::CsrOffsets() const {
+        return mapped_graph ? mapped_graph->offsets : csr_offsets.data();
+    }
+
+    const AdjacencyInfo* ALGraph::CsrEdges() const {
+        return mapped_graph ? mapped_graph->edges : csr_edges.data();
+    }
+
+    const unsigned* ALGraph::ReverseOffsets() const {
+        return mapped_graph ? mapped_graph->reverse_offsets : reverse_offsets.data();
+    }
+
+    const AdjacencyInfo* ALGraph::ReverseEdges() const {
+        return mapped_graph ? mapped_graph->reverse_edges : reverse_edges.data();
+    }
+
+    /*!
+      \brief
+      function to turn an id the caller gave into the id used inside the graph
+
+      \param node
+      id the caller gave the node
+
+      \return
+      returns the id of the node in the adjacency storage
+    */
+    unsigned ALGraph::ToInternal(unsigned node) const {
+        return internal_id.empty() ? node : internal_id[node-1];
+    }
+
+    /*!
+      \brief
+      function to turn an id used inside the graph back into the id the caller gave
+
+      \param node
+      id of the node in the adjacency storage
+
+      \return
+      returns the id the caller gave the node
+    */
+    unsigned ALGraph::ToExternal(unsigned node) const {
+        return external_id.empty() ? node : external_id[node-1];
+    }
+
+    /*!
+      \brief
+      function to move the cost and previous node of every node of a finished
+      search to the ids the caller gave, using the heap of the workspace as
+      scratch space. does nothing unless the graph was reordered
+
+      \param workspace
+      workspace filled in by Search
+
+      \return
+      none
+    */
+    void ALGraph::ToExternalOrder(DijkstraWorkspace& workspace) const {
+        if(external_id.empty()){
+            return;
+        }
+
+        //id holds the previous node and weight the cost, at the position of the
+        //node the caller knows
+        std::vector<AdjacencyInfo>& scratch = workspace.heap;
+        scratch.resize(total_num_of_nodes);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            AdjacencyInfo& entry = scratch[external_id[i]-1];
+            entry.id = workspace.previous[i] ? external_id[workspace.previous[i]-1] : 0;
+            entry.weight = workspace.dist[i];
+        }
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            workspace.previous[i] = scratch[i].id;
+            workspace.dist[i] = scratch[i].weight;
+        }
+        scratch.clear();
+    }
+
+    /*!
+      \brief
+      function to copy the packed edges of a mapped file into the graph, so they
+      can be written to
+
+      \return
+      none
+    */
+    void ALGraph::OwnPackedEdges() {
+        if(!mapped_graph){
+            return;
+        }
+        const unsigned edge_count = CsrOffsets()[total_num_of_nodes];
+        csr_offsets.assign(CsrOffsets(), CsrOffsets() + total_num_of_nodes + 1);
+        csr_edges.assign(CsrEdges(), CsrEdges() + edge_count);
+        reverse_offsets.assign(ReverseOffsets(), ReverseOffsets() + total_num_of_nodes + 1);
+        reverse_edges.assign(ReverseEdges(), ReverseEdges() + edge_count);
+        mapped_graph.reset();
+    }
+
+    /*!
+      \brief
+      function to repair a tracked tree after an edge got cheaper or was added,
+      by running Dijkstra only from the end of the edge
+
+      \param tree
+      tree to repair
+
+      \param from
+      node the edge starts from, an id inside the graph
+
+      \param to
+      node the edge ends at, an id inside the graph
+
+      \param weight
+      new weight of the edge
+
+      \return
+      none
+    */
+    void ALGraph::RepairDecrease(DijkstraTree& tree, unsigned from, unsigned to, unsigned weight) {
+        std::vector<unsigned>& cost = tree.cost;
+        std::vector<unsigned>& previous = tree.previous;
+        unsigned from_cost = cost[ToExternal(from)-1];
+        if(from_cost == INFINITY_ || from_cost + weight >= cost[ToExternal(to)-1]){
+            return;
+        }
+
+        check_greater_than greater_than;
+        repair_heap.clear();
+        cost[ToExternal(to)-1] = from_cost + weight;
+        previous[ToExternal(to)-1] = ToExternal(from);
+        AdjacencyInfo info;
+        info.id = to;
+        info.weight = from_cost + weight;
+        repair_heap.push_back(info);
+
+        //plain Dijkstra, but only nodes that get cheaper are ever queued
+        while(!repair_heap.empty()){
+            std::pop_heap(repair_heap.begin(), repair_heap.end(), greater_than);
+            AdjacencyInfo top = repair_heap.back();
+            repair_heap.pop_back();
+            unsigned int u = top.id;
+            if(top.weight > cost[ToExternal(u)-1]){
+                continue;
+            }
+
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned int new_cost = top.weight + neighbor->weight;
+                unsigned int v = ToExternal(neighbor->id);
+                if(new_cost < cost[v-1]){
+                    cost[v-1] = new_cost;
+                    previous[v-1] = ToExternal(u);
+                    info.id = neighbor->id;
+                    info.weight = new_cost;
+                    repair_heap.push_back(info);
+                    std::push_heap(repair_heap.begin(), repair_heap.end(), greater_than);
+                }
+            }
+        }
+    }
+
+    /*!
+      \brief
+      function to repair a tracked tree after a tree edge got more expensive. the
+      nodes below the edge in the tree lose their cost, get the cheapest cost
+      through an edge from outside of them, and Dijkstra settles them again
+
+      \param tree
+      tree to repair
+
+      \param to
+      node the edge ends at, an id inside the graph
+
+      \return
+      none
+    */
+    void ALGraph::RepairIncrease(DijkstraTree& tree, unsigned to) {
+        std::vector<unsigned>& cost = tree.cost;
+        std::vector<unsigned>& previous = tree.previous;
+        in_repair.resize(total_num_of_nodes, false);
+
+        //the subtree below to, children of a node are the nodes its edges lead to
+        //whose previous node it is
+        repair_nodes.clear();
+        repair_nodes.push_back(to);
+        in_repair[to-1] = true;
+        for(unsigned int i=0; i < repair_nodes.size(); ++i){
+            unsigned int u = repair_nodes[i];
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned int v = neighbor->id;
+                if(!in_repair[v-1] && previous[ToExternal(v)-1] == ToExternal(u)){
+                    in_repair[v-1] = true;
+                    repair_nodes.push_back(v);
+                }
+            }
+        }
+        for(unsigned u : repair_nodes){
+            cost[ToExternal(u)-1] = INFINITY_;
+            previous[ToExternal(u)-1] = 0;
+        }
+
+        //costs outside the subtree are still right, so the cheapest edge in from
+        //outside gives every node of the subtree a first cost
+        check_greater_than greater_than;
+        repair_heap.clear();
+        for(unsigned u : repair_nodes){
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetReverseNeighbours(u, first, last);
+            unsigned& u_cost = cost[ToExternal(u)-1];
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned p_cost = cost[ToExternal(neighbor->id)-1];
+                if(!in_repair[neighbor->id-1] && p_cost != INFINITY_ && p_cost + neighbor->weight < u_cost){
+                    u_cost = p_cost + neighbor->weight;
+                    previous[ToExternal(u)-1] = ToExternal(neighbor->id);
+                }
+            }
+            if(u_cost != INFINITY_){
+                AdjacencyInfo info;
+                info.id = u;
+                info.weight = u_cost;
+                repair_heap.push_back(info);
+            }
+        }
+        std::make_heap(repair_heap.begin(), repair_heap.end(), greater_than);
+
+        //then Dijkstra inside the subtree, costs only went up so nothing outside changes
+        while(!repair_heap.empty()){
+            std::pop_heap(repair_heap.begin(), repair_heap.end(), greater_than);
+            AdjacencyInfo top = repair_heap.back();
+            repair_heap.pop_back();
+            unsigned int u = top.id;
+            if(top.weight > cost[ToExternal(u)-1]){
+                continue;
+            }
+
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned int new_cost = top.weight + neighbor->weight;
+                unsigned int v = ToExternal(neighbor->id);
+                if(in_repair[neighbor->id-1] && new_cost < cost[v-1]){
+                    cost[v-1] = new_cost;
+                    previous[v-1] = ToExternal(u);
+                    AdjacencyInfo info;
+                    info.id = neighbor->id;
+                    info.weight = new_cost;
+                    repair_heap.push_back(info);
+                    std::push_heap(repair_heap.begin(), repair_heap.end(), greater_than);
+                }
+            }
+        }
+
+        for(unsigned u : repair_nodes){
+            in_repair[u-1] = false;
+        }
+    }
+
+    /*!
+      \brief
+      function to build the path from the start of a search to a node, out of the
+      previous node of every node
+
+      \param dist
+      cost of every node, static_cast<unsigned>(-1) if unreachable
+
+      \param previous
+      previous node of every node, 0 for the start node
+
+      \param node
+      last node of the path
+
+      \param path
+      cleared, then filled with the path. left empty if node cannot be reached
+
+      \return
+      none
+    */
+    static void BuildPath(const std::vector<unsigned>& dist, const std::vector<unsigned>& previous,
+                          unsigned node, std::vector<unsigned>& path) {
+        path.clear();
+        if(dist[node-1] == INFINITY_){
+            return;
+        }
+
+        //walk back to the start node, then flip the path around
+        for(unsigned int curr_node = node; curr_node != 0; curr_node = previous[curr_node-1]){
+            path.push_back(curr_node);
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+    /*!
+      \brief
+      function that runs Dijkstra algorithm from a node into a workspace, the
+      shared part of every search
+
+      \param start_node
+      starting node for the algorithm
+
+      \param target_node
+      the search stops once this node is settled, 0 to settle every node
+
+      \param max_cost
+      nodes that cost more than this to reach are left unreachable
+
+      \param workspace
+      receives the cost and previous node of every node
+
+      \param settled_nodes
+      if not nullptr, every settled node is appended to it, cheapest first
+
+      \return
+      none
+    */
+    void ALGraph::Search(unsigned start_node, unsigned target_node, unsigned max_cost,
+                         DijkstraWorkspace& workspace, std::vector<unsigned>* settled_nodes) const {
+        switch(GetQueueStrategy()){
+            case QueueStrategy::DIAL:
+                SearchWith<DialQueue>(start_node, target_node, max_cost, workspace, settled_nodes);
+                break;
+            case QueueStrategy::RADIX_HEAP:
+                SearchWith<RadixHeapQueue>(start_node, target_node, max_cost, workspace, settled_nodes);
+                break;
+            default:
+                SearchWith<BinaryHeapQueue>(start_node, target_node, max_cost, workspace, settled_nodes);
+                break;
+        }
+    }
+
+    /*!
+      \brief
+      function that runs the search of Search with one kind of priority queue
+
+      \param start_node
+      starting node for the algorithm
+
+      \param target_node
+      the search stops once this node is settled, 0 to settle every node
+
+      \param max_cost
+      nodes that cost more than this to reach are left unreachable
+
+      \param workspace
+      receives the cost and previous node of every node
+
+      \param settled_nodes
+      if not nullptr, every settled node is appended to it, cheapest first
+
+      \return
+      none
+    */
+    template <typename Queue>
+    void ALGraph::SearchWith(unsigned start_node, unsigned target_node, unsigned max_cost,
+                             DijkstraWorkspace& workspace, std::vector<unsigned>* settled_nodes) const {
+        std::vector<unsigned>& dist = workspace.dist;
+        std::vector<unsigned>& previous = workspace.previous;
+        Queue queue(workspace, max_weight);
+
+        dist.assign(total_num_of_nodes, INFINITY_);
+        previous.assign(total_num_of_nodes, 0);
+
+        //distance to start node, from the start node, is 0
+        dist[start_node-1] = 0;
+        queue.Push(start_node, 0);
+
+        //while pq is not empty
+        while(!queue.Empty()){
+            //extract the min
+            AdjacencyInfo top = queue.Pop();
+            unsigned int u = top.id;
+
+            //node was pushed again with a smaller cost since, this entry is stale
+            if(top.weight > dist[u-1]){
+                continue;
+            }
+
+            //cost of u is final from here on
+            if(settled_nodes){
+                settled_nodes->push_back(u);
+            }
+            if(u == target_node){
+                break;
+            }
+
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            GetNeighbours(u, first, last);
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned int v = neighbor->id;
+                unsigned int new_cost = dist[u-1] + neighbor->weight;
+
+                //if distance to node +weight is lesser than current stored distance, replace it
+                if(new_cost <= max_cost && new_cost < dist[v-1]){
+                    dist[v-1] = new_cost;
+                    previous[v-1] = u;
+
+                    //store into pq
+                    queue.Push(v, new_cost);
+                }
+            }
+        }
+    }
+
+    /*!
+      \brief
+      function that runs Dijkstra algorithm from a node into a workspace owned by
+      the caller. the graph is only read, so any number of threads can search one
+      graph at the same time, each with its own workspace
+
+      \param start_node
+      starting node for the algorithm
+
+      \param workspace
+      receives the cost and previous node of every node. its vectors keep their
+      memory between calls, so reusing one workspace does not allocate
+
+      \return
+      none
+    */
+    void ALGraph::Dijkstra(unsigned start_node, DijkstraWorkspace& workspace) const {
+        Search(ToInternal(start_node), 0, INFINITY_, workspace, nullptr);
+        ToExternalOrder(workspace);
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes. the search stops as
+      soon as target is settled instead of settling every node
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ALGraph::ShortestPath(unsigned source, unsigned target) const {
+        DijkstraWorkspace workspace;
+        return ShortestPath(source, target, workspace);
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes, using a workspace
+      owned by the caller
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param workspace
+      holds the search state, only the nodes settled before target are final
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ALGraph::ShortestPath(unsigned source, unsigned target, DijkstraWorkspace& workspace) const {
+        Search(ToInternal(source), ToInternal(target), INFINITY_, workspace, nullptr);
+
+        DijkstraInfo result;
+        result.cost = workspace.dist[ToInternal(target)-1];
+        BuildPath(workspace.dist, workspace.previous, ToInternal(target), result.path);
+        for(unsigned& node : result.path){
+            node = ToExternal(node);
+        }
+        ToExternalOrder(workspace);
+        return result;
+    }
+
+    /*!
+      \brief
+      function to find every node within a cost of a node. the search stops at
+      the cost bound instead of settling every node
+
+      \param source
+      node the search starts from
+
+      \param max_cost
+      largest total cost a node may have to be included
+
+      \return
+      returns the reachable nodes cheapest first, id is the node and weight is
+      the total cost to reach it. source itself is the first entry
+    */
+    std::vector<AdjacencyInfo> ALGraph::Reachable(unsigned source, unsigned max_cost) const {
+        DijkstraWorkspace workspace;
+        return Reachable(source, max_cost, workspace);
+    }
+
+    /*!
+      \brief
+      function to find every node within a cost of a node, using a workspace
+      owned by the caller
+
+      \param source
+      node the search starts from
+
+      \param max_cost
+      largest total cost a node may have to be included
+
+      \param workspace
+      holds the search state, previous can be used to build paths to the nodes
+
+      \return
+      returns the reachable nodes cheapest first, id is the node and weight is
+      the total cost to reach it. source itself is the first entry
+    */
+    std::vector<AdjacencyInfo> ALGraph::Reachable(unsigned source, unsigned max_cost, DijkstraWorkspace& workspace) const {
+        std::vector<unsigned> settled_nodes;
+        Search(ToInternal(source), 0, max_cost, workspace, &settled_nodes);
+
+        std::vector<AdjacencyInfo> reachable(settled_nodes.size());
+        for(unsigned int i=0; i < settled_nodes.size(); ++i){
+            reachable[i].id = ToExternal(settled_nodes[i]);
+            reachable[i].weight = workspace.dist[settled_nodes[i]-1];
+        }
+        ToExternalOrder(workspace);
+        return reachable;
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes by searching forward
+      from source and backward from target at the same time, which settles far
+      fewer nodes on large graphs. needs the reverse edges built by Freeze, on a
+      graph that is not frozen it is the same as ShortestPath
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ALGraph::BidirectionalShortestPath(unsigned source, unsigned target) const {
+        DijkstraWorkspace forward;
+        DijkstraWorkspace backward;
+        return BidirectionalShortestPath(source, target, forward, backward);
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes by searching from both
+      ends, using workspaces owned by the caller
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param forward
+      holds the search state of the search from source
+
+      \param backward
+      holds the search state of the search from target, previous is the next
+      node towards target
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ALGraph::BidirectionalShortestPath(unsigned source, unsigned target,
+                                                    DijkstraWorkspace& forward, DijkstraWorkspace& backward) const {
+        if(!frozen || source == target){
+            return ShortestPath(source, target, forward);
+        }
+        source = ToInternal(source);
+        target = ToInternal(target);
+
+        check_greater_than greater_than;
+        DijkstraWorkspace* sides[2] = { &forward, &backward };
+        for(DijkstraWorkspace* side : sides){
+            side->dist.assign(total_num_of_nodes, INFINITY_);
+            side->previous.assign(total_num_of_nodes, 0);
+            side->heap.clear();
+        }
+
+        AdjacencyInfo info;
+        info.weight = 0;
+        info.id = source;
+        forward.dist[source-1] = 0;
+        forward.heap.push_back(info);
+        info.id = target;
+        backward.dist[target-1] = 0;
+        backward.heap.push_back(info);
+
+        //cheapest full path seen so far goes through meeting_node
+        unsigned long long best_cost = INFINITY_;
+        unsigned meeting_node = 0;
+
+        while(!forward.heap.empty() && !backward.heap.empty()){
+            //no path through an unsettled node can beat best_cost any more
+            unsigned long long lower_bound = static_cast<unsigned long long>(forward.heap.front().weight) + backward.heap.front().weight;
+            if(lower_bound >= best_cost){
+                break;
+            }
+
+            //grow whichever side has the cheaper frontier
+            bool forward_turn = forward.heap.front().weight <= backward.heap.front().weight;
+            DijkstraWorkspace& side = forward_turn ? forward : backward;
+            const DijkstraWorkspace& other = forward_turn ? backward : forward;
+
+            std::pop_heap(side.heap.begin(), side.heap.end(), greater_than);
+            AdjacencyInfo top = side.heap.back();
+            side.heap.pop_back();
+            unsigned int u = top.id;
+            if(top.weight > side.dist[u-1]){
+                continue;
+            }
+
+            const AdjacencyInfo* first;
+            const AdjacencyInfo* last;
+            if(forward_turn){
+                GetNeighbours(u, first, last);
+            }
+            else{
+                GetReverseNeighbours(u, first, last);
+            }
+
+            for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                unsigned int v = neighbor->id;
+                unsigned int new_cost = side.dist[u-1] + neighbor->weight;
+                if(new_cost < side.dist[v-1]){
+                    side.dist[v-1] = new_cost;
+                    side.previous[v-1] = u;
+                    AdjacencyInfo info2;
+                    info2.id = v;
+                    info2.weight = new_cost;
+                    side.heap.push_back(info2);
+                    std::push_heap(side.heap.begin(), side.heap.end(), greater_than);
+                }
+
+                //the two searches touch at v
+                if(other.dist[v-1] != INFINITY_){
+                    unsigned long long through_v = static_cast<unsigned long long>(side.dist[v-1]) + other.dist[v-1];
+                    if(through_v < best_cost){
+                        best_cost = through_v;
+                        meeting_node = v;
+                    }
+                }
+            }
+        }
+
+        DijkstraInfo result;
+        result.cost = INFINITY_;
+        if(meeting_node == 0){
+            ToExternalOrder(forward);
+            ToExternalOrder(backward);
+            return result;
+        }
+
+        //source to the meeting node from the forward search, the rest from the backward
+        //search, where the previous node is the next one towards target
+        result.cost = static_cast<unsigned>(best_cost);
+        BuildPath(forward.dist, forward.previous, meeting_node, result.path);
+        for(unsigned int curr_node = backward.previous[meeting_node-1]; curr_node != 0; curr_node = backward.previous[curr_node-1]){
+            result.path.push_back(curr_node);
+        }
+        for(unsigned& node : result.path){
+            node = ToExternal(node);
+        }
+        ToExternalOrder(forward);
+        ToExternalOrder(backward);
+        return result;
+    }
+
+    /*!
+      \brief
+      function to find the cost between every source and every target. one
+      Dijkstra search is run per source, spread over a number of threads that
+      each have their own workspace
+
+      \param sources
+      nodes the paths start from
+
+      \param targets
+      nodes the paths end at
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      returns a row major matrix, the cost from sources[i] to targets[j] is at
+      i * targets.size() + j, static_cast<unsigned>(-1) if it cannot be reached
+    */
+    std::vector<unsigned> ALGraph::DistanceMatrix(const std::vector<unsigned>& sources, const std::vector<unsigned>& targets,
+                                                  unsigned thread_count) const {
+        std::vector<unsigned> matrix(sources.size() * targets.size());
+        DistanceMatrix(sources, targets, matrix.data(), thread_count);
+        return matrix;
+    }
+
+    /*!
+      \brief
+      function to find the cost between every source and every target, written
+      into a matrix owned by the caller
+
+      \param sources
+      nodes the paths start from
+
+      \param targets
+      nodes the paths end at
+
+      \param matrix
+      receives sources.size() * targets.size() costs, row major
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      none
+    */
+    void ALGraph::DistanceMatrix(const std::vector<unsigned>& sources, const std::vector<unsigned>& targets,
+                                 unsigned* matrix, unsigned thread_count) const {
+        if(thread_count == 0){
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = std::min<unsigned>(thread_count, static_cast<unsigned>(sources.size()));
+
+        //threads take the next source as they finish, so uneven searches still spread out.
+        //every row is written by exactly one thread, nothing else is shared
+        std::atomic<unsigned> next_source(0);
+        auto worker = [&](){
+            DijkstraWorkspace workspace;
+            for(unsigned int i = next_source++; i < sources.size(); i = next_source++){
+                //left in the ids inside the graph, only the targets are looked up
+                Search(ToInternal(sources[i]), 0, INFINITY_, workspace, nullptr);
+                unsigned* row = matrix + static_cast<std::size_t>(i) * targets.size();
+                for(unsigned int j=0; j < targets.size(); ++j){
+                    row[j] = workspace.dist[ToInternal(targets[j])-1];
+                }
+            }
+        };
+
+        if(thread_count <= 1){
+            worker();
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for(unsigned int t=1; t < thread_count; ++t){
+            threads.emplace_back(worker);
+        }
+        worker();
+        for(std::thread& thread : threads){
+            thread.join();
+        }
+    }
+
+    /*!
+      \brief
+      function to find the cost to every node from one node with delta stepping,
+      which spreads a single search over many threads. nodes are put in buckets
+      of delta wide cost ranges, and every node of the cheapest bucket is
+      expanded at once. the costs are exactly those of Dijkstra
+
+      \param start_node
+      starting node for the algorithm
+
+      \param delta
+      width of a bucket, 0 uses the average edge weight. small values do less
+      extra work, large values give each step more nodes to share out
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      returns the cost of every node, static_cast<unsigned>(-1) if it cannot be reached
+    */
+    std::vector<unsigned> ALGraph::DeltaStepping(unsigned start_node, unsigned delta, unsigned thread_count) const {
+        const unsigned NO_BUCKET = INFINITY_;
+        if(delta == 0){
+            delta = total_edges ? static_cast<unsigned>(std::max(1ull, total_weight / total_edges)) : 1;
+        }
+        if(thread_count == 0){
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        //every queued cost is at most max weight above the bucket being expanded,
+        //so a ring of this many buckets is enough
+        const unsigned bucket_count = max_weight / delta + 2;
+        std::vector<std::vector<unsigned>> buckets(bucket_count);
+        std::vector<unsigned> bucket_of(total_num_of_nodes, NO_BUCKET);
+        std::vector<std::atomic<unsigned>> dist(total_num_of_nodes);
+        for(std::atomic<unsigned>& cost : dist){
+            cost.store(INFINITY_, std::memory_order_relaxed);
+        }
+
+        //nodes each thread lowered the cost of during the current phase
+        std::vector<std::vector<unsigned>> improved(thread_count);
+        std::vector<unsigned> frontier;
+        std::vector<unsigned> settled;
+        unsigned long long queued = 0;
+        unsigned current_bucket = 0;
+        bool finished = false;
+        bool bucket_empty = false;
+
+        start_node = ToInternal(start_node);
+        dist[start_node-1].store(0);
+        bucket_of[start_node-1] = 0;
+        buckets[0].push_back(start_node);
+        queued = 1;
+
+        //lowers the cost of v to new_cost if that is cheaper, with compare and swap
+        //so threads relaxing the same node at once still keep the smallest cost
+        auto relax = [&](unsigned v, unsigned new_cost, std::vector<unsigned>& lowered){
+            unsigned int old_cost = dist[v-1].load(std::memory_order_relaxed);
+            while(new_cost < old_cost){
+                if(dist[v-1].compare_exchange_weak(old_cost, new_cost, std::memory_order_relaxed)){
+                    lowered.push_back(v);
+                    return;
+                }
+            }
+        };
+
+        //relaxes the light (weight <= delta) or heavy edges of this thread's share of nodes
+        auto expand = [&](const std::vector<unsigned>& nodes, bool light, unsigned thread){
+            std::size_t begin = nodes.size() * thread / thread_count;
+            std::size_t end = nodes.size() * (thread + 1) / thread_count;
+            for(std::size_t i = begin; i < end; ++i){
+                unsigned int u = nodes[i];
+                unsigned int cost = dist[u-1].load(std::memory_order_relaxed);
+                const AdjacencyInfo* first;
+                const AdjacencyInfo* last;
+                GetNeighbours(u, first, last);
+                for(const AdjacencyInfo* neighbor = first; neighbor != last; ++neighbor){
+                    if((neighbor->weight <= delta) == light){
+                        relax(neighbor->id, cost + neighbor->weight, improved[thread]);
+                    }
+                }
+            }
+        };
+
+        //files every lowered node under its new bucket, one thread only
+        auto file_improved = [&](){
+            for(std::vector<unsigned>& lowered : improved){
+                for(unsigned v : lowered){
+                    unsigned int bucket = dist[v-1].load(std::memory_order_relaxed) / delta;
+                    if(bucket_of[v-1] != bucket){
+                        bucket_of[v-1] = bucket;
+                        buckets[bucket % bucket_count].push_back(v);
+                        ++queued;
+                    }
+                }
+                lowered.clear();
+            }
+        };
+
+        //empties the current bucket into frontier, dropping nodes that have since
+        //moved to a cheaper bucket. one thread only
+        auto take_bucket = [&](){
+            frontier.clear();
+            std::vector<unsigned>& bucket = buckets[current_bucket % bucket_count];
+            queued -= bucket.size();
+            for(unsigned v : bucket){
+                if(bucket_of[v-1] == current_bucket){
+                    bucket_of[v-1] = NO_BUCKET;
+                    frontier.push_back(v);
+                }
+            }
+            bucket.clear();
+            bucket_empty = frontier.empty();
+        };
+
+        //every thread runs the same steps, thread 0 does the bookkeeping between barriers
+        SpinBarrier barrier(thread_count);
+        auto run = [&](unsigned thread){
+            for(;;){
+                if(thread == 0){
+                    while(queued != 0 && buckets[current_bucket % bucket_count].empty()){
+                        ++current_bucket;
+                    }
+                    finished = queued == 0;
+                    if(!finished){
+                        settled.clear();
+                        take_bucket();
+                    }
+                }
+                barrier.Wait();
+                if(finished){
+                    return;
+                }
+
+                //light edges can put nodes back into the current bucket, so repeat
+                //until it stays empty
+                for(;;){
+                    expand(frontier, true, thread);
+                    barrier.Wait();
+                    if(thread == 0){
+                        settled.insert(settled.end(), frontier.begin(), frontier.end());
+                        file_improved();
+                        take_bucket();
+                    }
+                    barrier.Wait();
+                    if(bucket_empty){
+                        break;
+                    }
+                }
+
+                //every node of the bucket is final now, heavy edges only need one pass
+                expand(settled, false, thread);
+                barrier.Wait();
+                if(thread == 0){
+                    file_improved();
+                    ++current_bucket;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for(unsigned int t=1; t < thread_count; ++t){
+            threads.emplace_back(run, t);
+        }
+        run(0);
+        for(std::thread& thread : threads){
+            thread.join();
+        }
+
+        std::vector<unsigned> costs(total_num_of_nodes);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            costs[ToExternal(i+1)-1] = dist[i].load(std::memory_order_relaxed);
+        }
+        return costs;
+    }
+
+    /*!
+      \brief
+      function that implements Dijkstra algorithm to calculate all paths to every
+      node, starting from an arbitrary node
+
+      \param start_node
+      starting node for the algorithm
+
+      \return
+      returns a vector of DijkstraInfo, keeping track of the total cost of the path
+      as well as the nodes that the path consist of
+    */
+    std::vector<DijkstraInfo> ALGraph::Dijkstra(unsigned start_node) const {
+        DijkstraTree tree = ShortestPathTree(start_node);
+
+        std::vector<DijkstraInfo> tmp(total_num_of_nodes);
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            tmp[i].cost = tree.GetCost(i+1);
+            tree.GetPath(i+1, tmp[i].path);
+        }
+        return tmp;
+    }
+
+    /*!
+      \brief
+      function that runs Dijkstra algorithm from a node and returns only the cost
+      and previous node of every node, no paths are built
+
+      \param start_node
+      starting node for the algorithm
+
+      \return
+      returns a DijkstraTree, which builds the path to a node when asked
+    */
+    DijkstraTree ALGraph::ShortestPathTree(unsigned start_node) const {
+        DijkstraWorkspace workspace;
+        Dijkstra(start_node, workspace);
+
+        //the workspace is thrown away, so its arrays can be moved instead of copied
+        DijkstraTree tree;
+        tree.source = start_node;
+        tree.cost.swap(workspace.dist);
+        tree.previous.swap(workspace.previous);
+        return tree;
+    }
+
+    /*!
+      \brief
+      constructor for an empty DijkstraTree, filled in by ALGraph::ShortestPathTree
+
+      \return
+      none
+    */
+    DijkstraTree::DijkstraTree() : source(0) {
+    }
+
+    /*!
+      \brief
+      function to get the node the search started from
+
+      \return
+      returns the start node, 0 if the tree is empty
+    */
+    unsigned DijkstraTree::GetSource() const {
+        return source;
+    }
+
+    /*!
+      \brief
+      function to get the number of nodes in the tree
+
+      \return
+      returns the number of nodes of the graph that was searched
+    */
+    unsigned DijkstraTree::GetSize() const {
+        return static_cast<unsigned>(cost.size());
+    }
+
+    /*!
+      \brief
+      function to get the total cost of the shortest path to a node
+
+      \param node
+      node to get the cost of
+
+      \return
+      returns the cost, static_cast<unsigned>(-1) if the node cannot be reached
+    */
+    unsigned DijkstraTree::GetCost(unsigned node) const {
+        return cost[node-1];
+    }
+
+    /*!
+      \brief
+      function to get the node before a node on its shortest path
+
+      \param node
+      node to get the previous node of
+
+      \return
+      returns the previous node, 0 for the start node and for unreachable nodes
+    */
+    unsigned DijkstraTree::GetPrevious(unsigned node) const {
+        return previous[node-1];
+    }
+
+    /*!
+      \brief
+      function to check if a node can be reached from the start node
+
+      \param node
+      node to check
+
+      \return
+      returns true if there is a path from the start node to node
+    */
+    bool DijkstraTree::IsReachable(unsigned node) const {
+        return cost[node-1] != INFINITY_;
+    }
+
+    /*!
+      \brief
+      function to build the path from the start node to a node, into a vector
+      owned by the caller so a reused vector does not allocate
+
+      \param node
+      last node of the path
+
+      \param path
+      cleared, then filled with the nodes from the start node to node. left
+      empty if node cannot be reached
+
+      \return
+      none
+    */
+    void DijkstraTree::GetPath(unsigned node, std::vector<unsigned>& path) const {
+        BuildPath(cost, previous, node, path);
+    }
+
+    /*!
+      \brief
+      function to build the path from the start node to a node
+
+      \param node
+      last node of the path
+
+      \return
+      returns the nodes from the start node to node, empty if node cannot be reached
+    */
+    std::vector<unsigned> DijkstraTree::GetPath(unsigned node) const {
+        std::vector<unsigned> path;
+        GetPath(node, path);
+        return path;
+    }
@@ -16,8 +16,7 @@
 #define ALGRAPH_H
 //---------------------------------------------------------------------------
 #include <vector> //used for ALIST 
-#include <queue> //used for priority queue
-#include <map> //used for Dijkstra Algorithm
+#include <memory> //used to share a mapped graph file between copies
 
 //struct used to keep track of cost and the path from source node to another node
 struct DijkstraInfo
@@ -34,9 +33,63 @@ struct AdjacencyInfo
 };
 
 
+//struct used to describe one edge when adding many edges at once
+struct EdgeInfo
+{
+  unsigned source;
+  unsigned destination;
+  unsigned weight;
+};
+
+
 typedef std::vector<std::vector<AdjacencyInfo>> ALIST;
 
-//functor used for priority queue
+//packed edges of a graph file opened by LoadBinary, defined in ALGraph.cpp
+struct MappedGraph;
+
+//struct used to hold the state of one Dijkstra search, owned by the caller so
+//searches on the same graph do not share anything. previous is 0 for the start
+//node and for unreachable nodes, dist is static_cast<unsigned>(-1) if unreachable
+struct DijkstraWorkspace
+{
+  std::vector<unsigned> dist;
+  std::vector<unsigned> previous;
+  std::vector<AdjacencyInfo> heap;
+  std::vector<std::vector<AdjacencyInfo>> buckets;
+};
+
+//priority queue used by the searches. every key is a whole number that never goes
+//below the last key taken out, so bucket queues can replace the binary heap.
+//AUTO picks DIAL when the largest edge weight is small and RADIX_HEAP otherwise.
+//the costs are the same with every queue, but among paths of equal cost the bucket
+//queues can pick a different one than the binary heap, which is the default
+enum class QueueStrategy
+{
+  AUTO,
+  BINARY_HEAP,
+  DIAL,
+  RADIX_HEAP
+};
+
+//order ALGraph::Reorder renumbers the nodes in, inside the graph only. ORIGINAL
+//goes back to the ids the caller gave, BFS numbers nodes in breadth first order
+//so neighbours get close ids, and REVERSE_CUTHILL_MCKEE does the same from a low
+//degree node, lowest degree neighbours first, which keeps edges even shorter
+enum class NodeOrder
+{
+  ORIGINAL,
+  BFS,
+  REVERSE_CUTHILL_MCKEE
+};
+
+//struct used to give ALGraph::ReorderByPosition the position of a node
+struct NodePosition
+{
+  float x;
+  float y;
+};
+
+//functor used for the Dijkstra heap
 struct check_greater_than {
     bool operator()(const AdjacencyInfo& lhs, const AdjacencyInfo& rhs){
         return lhs.weight > rhs.weight;
@@ -60,6 +113,191 @@ struct check_smaller_than {
     }
 };
 
+//class used to hold the result of a Dijkstra search as a shortest path tree, the
+//cost and previous node of every node. paths are only built when asked for
+class DijkstraTree
+{
+  public:
+
+    /*!
+      \brief
+      constructor for an empty DijkstraTree, filled in by ALGraph::ShortestPathTree
+
+      \return
+      none
+    */
+    DijkstraTree(void);
+
+    /*!
+      \brief
+      function to get the node the search started from
+
+      \return
+      returns the start node, 0 if the tree is empty
+    */
+    unsigned GetSource(void) const;
+
+    /*!
+      \brief
+      function to get the number of nodes in the tree
+
+      \return
+      returns the number of nodes of the graph that was searched
+    */
+    unsigned GetSize(void) const;
+
+    /*!
+      \brief
+      function to get the total cost of the shortest path to a node
+
+      \param node
+      node to get the cost of
+
+      \return
+      returns the cost, static_cast<unsigned>(-1) if the node cannot be reached
+    */
+    unsigned GetCost(unsigned node) const;
+
+    /*!
+      \brief
+      function to get the node before a node on its shortest path
+
+      \param node
+      node to get the previous node of
+
+      \return
+      returns the previous node, 0 for the start node and for unreachable nodes
+    */
+    unsigned GetPrevious(unsigned node) const;
+
+    /*!
+      \brief
+      function to check if a node can be reached from the start node
+
+      \param node
+      node to check
+
+      \return
+      returns true if there is a path from the start node to node
+    */
+    bool IsReachable(unsigned node) const;
+
+    /*!
+      \brief
+      function to build the path from the start node to a node, into a vector
+      owned by the caller so a reused vector does not allocate
+
+      \param node
+      last node of the path
+
+      \param path
+      cleared, then filled with the nodes from the start node to node. left
+      empty if node cannot be reached
+
+      \return
+      none
+    */
+    void GetPath(unsigned node, std::vector<unsigned>& path) const;
+
+    /*!
+      \brief
+      function to build the path from the start node to a node
+
+      \param node
+      last node of the path
+
+      \return
+      returns the nodes from the start node to node, empty if node cannot be reached
+    */
+    std::vector<unsigned> GetPath(unsigned node) const;
+
+  private:
+    friend class ALGraph;
+
+    unsigned source;
+    std::vector<unsigned> cost;
+    std::vector<unsigned> previous;
+};
+
+class ALGraph;
+
+//class used to read the edges leaving one node in place, without copying them.
+//works the same whether the graph is frozen or not. edges come out by value, with
+//the ids of a reordered graph turned back into the ids the caller gave, and the
+//view is only valid until the graph is changed
+class AdjacencyView
+{
+  public:
+    class Iterator
+    {
+      public:
+        Iterator(const AdjacencyInfo* edge, const unsigned* external_id) : edge(edge), external_id(external_id) {}
+
+        AdjacencyInfo operator*() const { return Translate(*edge, external_id); }
+        Iterator& operator++() { ++edge; return *this; }
+        bool operator==(const Iterator& rhs) const { return edge == rhs.edge; }
+        bool operator!=(const Iterator& rhs) const { return edge != rhs.edge; }
+
+      private:
+        const AdjacencyInfo* edge;
+        const unsigned* external_id;
+    };
+
+    AdjacencyView(const AdjacencyInfo* first, const AdjacencyInfo* last, const unsigned* external_id = nullptr)
+      : first(first), last(last), external_id(external_id) {}
+
+    Iterator begin() const { return Iterator(first, external_id); }
+    Iterator end() const { return Iterator(last, external_id); }
+    unsigned size() const { return static_cast<unsigned>(last - first); }
+    bool empty() const { return first == last; }
+    AdjacencyInfo operator[](unsigned index) const { return Translate(first[index], external_id); }
+
+  private:
+    //external_id is nullptr unless the graph was reordered
+    static AdjacencyInfo Translate(AdjacencyInfo info, const unsigned* external_id) {
+      if(external_id){
+        info.id = external_id[info.id-1];
+      }
+      return info;
+    }
+
+    const AdjacencyInfo* first;
+    const AdjacencyInfo* last;
+    const unsigned* external_id;
+};
+
+//class used to read every adjacency list of a graph in place, indexed from 0 like
+//ALIST, so code written against GetAList works on it unchanged. only valid until
+//the graph is changed
+class AListView
+{
+  public:
+    class Iterator
+    {
+      public:
+        Iterator(const AListView* view, unsigned index) : view(view), index(index) {}
+
+        AdjacencyView operator*() const { return (*view)[index]; }
+        Iterator& operator++() { ++index; return *this; }
+        bool operator==(const Iterator& rhs) const { return index == rhs.index; }
+        bool operator!=(const Iterator& rhs) const { return index != rhs.index; }
+
+      private:
+        const AListView* view;
+        unsigned index;
+    };
+
+    AListView(const ALGraph& graph) : graph(graph) {}
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+    unsigned size() const;
+    AdjacencyView operator[](unsigned index) const;
+
+  private:
+    const ALGraph& graph;
+};
+
 class ALGraph
 {
   public:
@@ -121,6 +359,270 @@ class ALGraph
     */
     void AddUEdge(unsigned node1, unsigned node2, unsigned weight);
 
+    /*!
+      \brief
+      function to add many directed edges at once. every adjacency list is sorted
+      once after all the edges are in, instead of after every edge
+
+      \param edges
+      edges to add, source and destination as in AddDEdge
+
+      \return
+      none
+    */
+    void AddDEdges(const std::vector<EdgeInfo>& edges);
+
+    /*!
+      \brief
+      function to add many undirected edges at once. every adjacency list is sorted
+      once after all the edges are in, instead of after every edge
+
+      \param edges
+      edges to add, source and destination are the two nodes as in AddUEdge
+
+      \return
+      none
+    */
+    void AddUEdges(const std::vector<EdgeInfo>& edges);
+
+    /*!
+      \brief
+      function to start streaming edges in. until EndBulkLoad is called, AddDEdge
+      and AddUEdge only append to the adjacency lists without keeping them sorted
+
+      \return
+      none
+    */
+    void BeginBulkLoad(void);
+
+    /*!
+      \brief
+      function to finish streaming edges in, sorts every adjacency list once
+
+      \return
+      none
+    */
+    void EndBulkLoad(void);
+
+    /*!
+      \brief
+      function to compile the adjacency lists into compressed sparse row form,
+      one offsets array and one packed array of every edge. the lists are freed,
+      Dijkstra and GetAList read the packed edges instead. adding an edge or
+      starting a bulk load thaws the graph back into lists
+
+      \return
+      none
+    */
+    void Freeze(void);
+
+    /*!
+      \brief
+      function to turn the packed edges back into adjacency lists
+
+      \return
+      none
+    */
+    void Thaw(void);
+
+    /*!
+      \brief
+      function to check if the graph is in compressed sparse row form
+
+      \return
+      returns true if Freeze was called and the graph has not been thawed since
+    */
+    bool IsFrozen(void) const;
+
+    /*!
+      \brief
+      function to write the graph to a binary file that LoadBinary can map back
+      in without parsing. the file holds a versioned header and the packed
+      forward and reverse edges of Freeze, in the byte order of this machine.
+      a graph that is not frozen is packed into a copy first
+
+      \param filename
+      name of the file to write, replaced only once it is written completely
+
+      \return
+      returns false if the file could not be written
+    */
+    bool SaveBinary(const char* filename) const;
+
+    /*!
+      \brief
+      function to replace the graph with one written by SaveBinary. the file is
+      memory mapped and the graph is frozen on the mapped edges, so nothing is
+      copied and pages are only read in when a search touches them. the file
+      must not be changed while the graph, or a copy of it, is still in use
+
+      \param filename
+      name of the file to open
+
+      \return
+      returns false, leaving the graph as it was, if the file cannot be mapped, is
+      not a graph file of this version, or has offsets or edges that do not fit
+      the nodes and edges it says it holds
+    */
+    bool LoadBinary(const char* filename);
+
+    /*!
+      \brief
+      function to add the arcs of a DIMACS shortest path file, "p sp n m" then
+      one "a u v w" line per directed arc, "c" lines are comments. the file is
+      read in chunks and the edges are bulk loaded, so memory does not grow with
+      the size of the text
+
+      \param filename
+      name of the file to read
+
+      \return
+      returns false if the file cannot be read or a line cannot be parsed, the
+      edges before the bad line are kept
+    */
+    bool ImportDimacs(const char* filename);
+
+    /*!
+      \brief
+      function to add the edges of a text edge list, one "u v" or "u v w" line
+      per edge with node ids from 1, weight 1 when it is left out. lines starting
+      with '#' or '%' are comments. nodes are added when an id is past the last
+      node
+
+      \param filename
+      name of the file to read
+
+      \param undirected
+      true to add every edge in both directions
+
+      \return
+      returns false if the file cannot be read or a line cannot be parsed, the
+      edges before the bad line are kept
+    */
+    bool ImportEdgeList(const char* filename, bool undirected);
+
+    /*!
+      \brief
+      function to renumber the nodes inside the graph so that nodes joined by an
+      edge sit close together in memory, and searches jump around less. every
+      function still takes and returns the ids the caller gave, including the
+      paths, views and workspaces. a frozen graph is frozen again afterwards,
+      and a bulk load is finished first
+
+      \param order
+      order to number the nodes in, ORIGINAL undoes any earlier reordering
+
+      \return
+      none
+    */
+    void Reorder(NodeOrder order);
+
+    /*!
+      \brief
+      function to renumber the nodes inside the graph along a Hilbert curve
+      through their positions, so nodes close together in space are close
+      together in memory. works like Reorder otherwise
+
+      \param positions
+      position of every node, positions[node - 1]
+
+      \return
+      returns false, leaving the graph as it was, if there is not exactly one
+      position per node
+    */
+    bool ReorderByPosition(const std::vector<NodePosition>& positions);
+
+    /*!
+      \brief
+      function to change the weight of an edge in place, keeping the adjacency
+      list sorted. a frozen graph stays frozen, and a graph with tracked sources
+      is frozen first. the shortest path tree of every tracked source is
+      repaired, only the nodes whose cost can change are looked at instead of
+      running Dijkstra again. an undirected edge is two directed edges, change both
+
+      \param source
+      node that the edge starts from
+
+      \param destination
+      node that the edge is moving towards
+
+      \param weight
+      new weight of the edge, every parallel edge gets it
+
+      \return
+      returns false if there is no edge from source to destination
+    */
+    bool UpdateEdgeWeight(unsigned source, unsigned destination, unsigned weight);
+
+    /*!
+      \brief
+      function to keep a shortest path tree from a node up to date while edges
+      are added and weights change. the graph is frozen, since repairing the tree
+      after a weight goes up needs the edges coming into a node. while a source is
+      tracked AddDEdge and AddUEdge splice into the frozen graph, which moves the
+      edges after the new one along, a memory move over the edges per edge added.
+      AddDEdges, AddUEdges, BeginBulkLoad and new nodes still thaw the graph, and
+      the next UpdateEdgeWeight packs every edge again, so add edges in batches
+
+      \param source
+      node the tree starts from, tracking it again does nothing
+
+      \return
+      none
+    */
+    void TrackSource(unsigned source);
+
+    /*!
+      \brief
+      function to stop keeping the shortest path tree of a node
+
+      \param source
+      node given to TrackSource
+
+      \return
+      none
+    */
+    void UntrackSource(unsigned source);
+
+    /*!
+      \brief
+      function to get the shortest path tree kept for a node. equal cost paths
+      may differ from the ones a new Dijkstra search would pick
+
+      \param source
+      node given to TrackSource
+
+      \return
+      returns the tree, valid until the graph is changed, nullptr if source is
+      not tracked
+    */
+    const DijkstraTree* GetTrackedTree(unsigned source) const;
+
+    /*!
+      \brief
+      function to choose the priority queue that Dijkstra, ShortestPath and
+      Reachable use. BidirectionalShortestPath always uses the binary heap.
+      every queue gives the same costs, but DIAL, RADIX_HEAP and AUTO can pick a
+      different path among paths of equal cost than the binary heap does
+
+      \param strategy
+      queue to use, BINARY_HEAP by default
+
+      \return
+      none
+    */
+    void SetQueueStrategy(QueueStrategy strategy);
+
+    /*!
+      \brief
+      function to get the priority queue the searches will use, with AUTO
+      already resolved from the largest edge weight
+
+      \return
+      returns BINARY_HEAP, DIAL or RADIX_HEAP
+    */
+    QueueStrategy GetQueueStrategy(void) const;
+
     /*!
       \brief
       function that implements Dijkstra algorithm to calculate all paths to every
@@ -137,17 +639,550 @@ class ALGraph
 
     /*!
       \brief
-      function to get aList in ALGraph
+      function that runs Dijkstra algorithm from a node into a workspace owned by
+      the caller. the graph is only read, so any number of threads can search one
+      graph at the same time, each with its own workspace
 
-      \return
-      returns aList of type ALIST, which is a vector of vector of AdjacencyInfo
-    */
+      \param start_node
+      starting node for the algorithm
+
+      \param workspace
+      receives the cost and previous node of every node. its vectors keep their
+      memory between calls, so reusing one workspace does not allocate
+
+      \return
+      none
+    */
+    void Dijkstra(unsigned start_node, DijkstraWorkspace& workspace) const;
+
+    /*!
+      \brief
+      function that runs Dijkstra algorithm from a node and returns only the cost
+      and previous node of every node, no paths are built
+
+      \param start_node
+      starting node for the algorithm
+
+      \return
+      returns a DijkstraTree, which builds the path to a node when asked
+    */
+    DijkstraTree ShortestPathTree(unsigned start_node) const;
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes. the search stops as
+      soon as target is settled instead of settling every node
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ShortestPath(unsigned source, unsigned target) const;
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes, using a workspace
+      owned by the caller
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param workspace
+      holds the search state, only the nodes settled before target are final
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ShortestPath(unsigned source, unsigned target, DijkstraWorkspace& workspace) const;
+
+    /*!
+      \brief
+      function to find every node within a cost of a node. the search stops at
+      the cost bound instead of settling every node
+
+      \param source
+      node the search starts from
+
+      \param max_cost
+      largest total cost a node may have to be included
+
+      \return
+      returns the reachable nodes cheapest first, id is the node and weight is
+      the total cost to reach it. source itself is the first entry
+    */
+    std::vector<AdjacencyInfo> Reachable(unsigned source, unsigned max_cost) const;
+
+    /*!
+      \brief
+      function to find every node within a cost of a node, using a workspace
+      owned by the caller
+
+      \param source
+      node the search starts from
+
+      \param max_cost
+      largest total cost a node may have to be included
+
+      \param workspace
+      holds the search state, previous can be used to build paths to the nodes
+
+      \return
+      returns the reachable nodes cheapest first, id is the node and weight is
+      the total cost to reach it. source itself is the first entry
+    */
+    std::vector<AdjacencyInfo> Reachable(unsigned source, unsigned max_cost, DijkstraWorkspace& workspace) const;
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes by searching forward
+      from source and backward from target at the same time, which settles far
+      fewer nodes on large graphs. needs the reverse edges built by Freeze, on a
+      graph that is not frozen it is the same as ShortestPath
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo BidirectionalShortestPath(unsigned source, unsigned target) const;
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes by searching from both
+      ends, using workspaces owned by the caller
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param forward
+      holds the search state of the search from source
+
+      \param backward
+      holds the search state of the search from target, previous is the next
+      node towards target
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo BidirectionalShortestPath(unsigned source, unsigned target,
+                                           DijkstraWorkspace& forward, DijkstraWorkspace& backward) const;
+
+    /*!
+      \brief
+      function to find the cost between every source and every target. one
+      Dijkstra search is run per source, spread over a number of threads that
+      each have their own workspace
+
+      \param sources
+      nodes the paths start from
+
+      \param targets
+      nodes the paths end at
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      returns a row major matrix, the cost from sources[i] to targets[j] is at
+      i * targets.size() + j, static_cast<unsigned>(-1) if it cannot be reached
+    */
+    std::vector<unsigned> DistanceMatrix(const std::vector<unsigned>& sources, const std::vector<unsigned>& targets,
+                                         unsigned thread_count = 0) const;
+
+    /*!
+      \brief
+      function to find the cost between every source and every target, written
+      into a matrix owned by the caller
+
+      \param sources
+      nodes the paths start from
+
+      \param targets
+      nodes the paths end at
+
+      \param matrix
+      receives sources.size() * targets.size() costs, row major
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      none
+    */
+    void DistanceMatrix(const std::vector<unsigned>& sources, const std::vector<unsigned>& targets,
+                        unsigned* matrix, unsigned thread_count = 0) const;
+
+    /*!
+      \brief
+      function to find the cost to every node from one node with delta stepping,
+      which spreads a single search over many threads. nodes are put in buckets
+      of delta wide cost ranges, and every node of the cheapest bucket is
+      expanded at once. the costs are exactly those of Dijkstra
+
+      \param start_node
+      starting node for the algorithm
+
+      \param delta
+      width of a bucket, 0 uses the average edge weight. small values do less
+      extra work, large values give each step more nodes to share out
+
+      \param thread_count
+      number of threads to use, 0 uses one per hardware thread
+
+      \return
+      returns the cost of every node, static_cast<unsigned>(-1) if it cannot be reached
+    */
+    std::vector<unsigned> DeltaStepping(unsigned start_node, unsigned delta = 0, unsigned thread_count = 0) const;
+
+    /*!
+      \brief
+      function to get aList in ALGraph
+
+      \return
+      returns aList of type ALIST, which is a vector of vector of AdjacencyInfo
+    */
     ALIST GetAList(void) const;
+
+    /*!
+      \brief
+      function to read the edges leaving a node without copying them
+
+      \param node
+      node to get the edges of
+
+      \return
+      returns a view of the edges, sorted like GetAList except while bulk loading
+    */
+    AdjacencyView GetAdjacency(unsigned node) const;
+
+    /*!
+      \brief
+      function to read every adjacency list without copying them, use instead of
+      GetAList when the lists are only looked at
+
+      \return
+      returns a view indexed from 0 like ALIST
+    */
+    AListView GetAListView(void) const;
+
+    /*!
+      \brief
+      function to get the number of nodes in the graph
+
+      \return
+      returns the number of nodes
+    */
+    unsigned GetNodeCount(void) const;
         
   private:
+    /*!
+      \brief
+      function to put one edge into the adjacency list of a node, in sorted
+      position, or at the back while bulk loading
+
+      \param node
+      node whose adjacency list gets the edge
+
+      \param info
+      the adjacent node and the weight of the edge
+
+      \return
+      none
+    */
+    void InsertAdjacency(unsigned node, const AdjacencyInfo& info);
+
+    /*!
+      \brief
+      function to put one edge into the packed edges of a frozen graph, in the
+      position Freeze would have given it, and into the reverse edges. the edges
+      after it are moved along by one, which is far cheaper than packing every
+      edge again
+
+      \param node
+      node the edge starts from
+
+      \param info
+      the adjacent node and the weight of the edge
+
+      \return
+      none
+    */
+    void SpliceEdge(unsigned node, const AdjacencyInfo& info);
+
+    /*!
+      \brief
+      function to get the edges leaving a node, from whichever storage is in use
+
+      \param node
+      node to get the edges of
+
+      \param first
+      set to the first edge of the node
+
+      \param last
+      set to one past the last edge of the node
+
+      \return
+      none
+    */
+    void GetNeighbours(unsigned node, const AdjacencyInfo*& first, const AdjacencyInfo*& last) const;
+
+    /*!
+      \brief
+      function to get the edges coming into a node, only valid while frozen
+
+      \param node
+      node to get the incoming edges of
+
+      \param first
+      set to the first incoming edge, its id is the node the edge comes from
+
+      \param last
+      set to one past the last incoming edge
+
+      \return
+      none
+    */
+    void GetReverseNeighbours(unsigned node, const AdjacencyInfo*& first, const AdjacencyInfo*& last) const;
+
+    /*!
+      \brief
+      function to turn an id the caller gave into the id used inside the graph
+
+      \param node
+      id the caller gave the node
+
+      \return
+      returns the id of the node in the adjacency storage
+    */
+    unsigned ToInternal(unsigned node) const;
+
+    /*!
+      \brief
+      function to turn an id used inside the graph back into the id the caller gave
+
+      \param node
+      id of the node in the adjacency storage
+
+      \return
+      returns the id the caller gave the node
+    */
+    unsigned ToExternal(unsigned node) const;
+
+    /*!
+      \brief
+      function to move the cost and previous node of every node of a finished
+      search to the ids the caller gave, using the heap of the workspace as
+      scratch space. does nothing unless the graph was reordered
+
+      \param workspace
+      workspace filled in by Search
+
+      \return
+      none
+    */
+    void ToExternalOrder(DijkstraWorkspace& workspace) const;
+
+    /*!
+      \brief
+      function to renumber the nodes, keeping every adjacency list in the same
+      order so results do not change
+
+      \param sequence
+      current ids of the nodes, in the order they get their new ids
+
+      \return
+      none
+    */
+    void ApplyOrder(const std::vector<unsigned>& sequence);
+
+    /*!
+      \brief
+      function to copy the packed edges of a mapped file into the graph, so they
+      can be written to
+
+      \return
+      none
+    */
+    void OwnPackedEdges(void);
+
+    /*!
+      \brief
+      function to repair a tracked tree after an edge got cheaper or was added,
+      by running Dijkstra only from the end of the edge
+
+      \param tree
+      tree to repair
+
+      \param from
+      node the edge starts from, an id inside the graph
+
+      \param to
+      node the edge ends at, an id inside the graph
+
+      \param weight
+      new weight of the edge
+
+      \return
+      none
+    */
+    void RepairDecrease(DijkstraTree& tree, unsigned from, unsigned to, unsigned weight);
+
+    /*!
+      \brief
+      function to repair a tracked tree after a tree edge got more expensive. the
+      nodes below the edge in the tree lose their cost, get the cheapest cost
+      through an edge from outside of them, and Dijkstra settles them again
+
+      \param tree
+      tree to repair
+
+      \param to
+      node the edge ends at, an id inside the graph
+
+      \return
+      none
+    */
+    void RepairIncrease(DijkstraTree& tree, unsigned to);
+
+    /*!
+      \brief
+      function to add nodes until the graph has at least node_count of them
+
+      \param node_count
+      number of nodes the graph needs
+
+      \return
+      none
+    */
+    void GrowTo(unsigned node_count);
+
+    /*!
+      \brief
+      function to read a text file in chunks and hand every line to a parser,
+      inside a bulk load
+
+      \param filename
+      name of the file to read
+
+      \param parse_line
+      called with the start and end of each line, returns false on a bad line
+
+      \return
+      returns false if the file cannot be read or parse_line returns false
+    */
+    template <typename LineParser>
+    bool ImportLines(const char* filename, LineParser parse_line);
+
+    //packed arrays of the frozen graph, from the mapped file if LoadBinary was used
+    const unsigned* CsrOffsets(void) const;
+    const AdjacencyInfo* CsrEdges(void) const;
+    const unsigned* ReverseOffsets(void) const;
+    const AdjacencyInfo* ReverseEdges(void) const;
+
+    /*!
+      \brief
+      function that runs Dijkstra algorithm from a node into a workspace, the
+      shared part of every search
+
+      \param start_node
+      starting node for the algorithm
+
+      \param target_node
+      the search stops once this node is settled, 0 to settle every node
+
+      \param max_cost
+      nodes that cost more than this to reach are left unreachable
+
+      \param workspace
+      receives the cost and previous node of every node
+
+      \param settled_nodes
+      if not nullptr, every settled node is appended to it, cheapest first
+
+      \return
+      none
+    */
+    void Search(unsigned start_node, unsigned target_node, unsigned max_cost,
+                DijkstraWorkspace& workspace, std::vector<unsigned>* settled_nodes) const;
+
+    /*!
+      \brief
+      function that runs the search of Search with one kind of priority queue
+
+      \param start_node
+      starting node for the algorithm
+
+      \param target_node
+      the search stops once this node is settled, 0 to settle every node
+
+      \param max_cost
+      nodes that cost more than this to reach are left unreachable
+
+      \param workspace
+      receives the cost and previous node of every node
+
+      \param settled_nodes
+      if not nullptr, every settled node is appended to it, cheapest first
+
+      \return
+      none
+    */
+    template <typename Queue>
+    void SearchWith(unsigned start_node, unsigned target_node, unsigned max_cost,
+                    DijkstraWorkspace& workspace, std::vector<unsigned>* settled_nodes) const;
+
      ALIST aList;
      unsigned int total_num_of_nodes;
-    mutable std::priority_queue<AdjacencyInfo, std::vector<AdjacencyInfo>, check_greater_than> priority_queue;
-    mutable std::map<unsigned int, DijkstraInfo> src_to_node;
+     bool bulk_loading;
+     QueueStrategy queue_strategy;
+     unsigned max_weight;
+     unsigned long long total_weight;
+     unsigned long long total_edges;
+
+     //compressed sparse row form, edges of node n are csr_edges[csr_offsets[n-1]] up to
+     //csr_edges[csr_offsets[n]]. empty unless frozen
+     bool frozen;
+     std::vector<unsigned> csr_offsets;
+     std::vector<AdjacencyInfo> csr_edges;
+
+     //the same edges reversed, built by Freeze for searches that run backwards
+     std::vector<unsigned> reverse_offsets;
+     std::vector<AdjacencyInfo> reverse_edges;
+
+     //set instead of the four arrays above when the frozen graph is a mapped file,
+     //shared by copies of the graph since it is never written
+     std::shared_ptr<const MappedGraph> mapped_graph;
+
+     //ids after Reorder, internal_id[original id - 1] and external_id[internal id - 1].
+     //both empty when the nodes have the ids the caller gave
+     std::vector<unsigned> internal_id;
+     std::vector<unsigned> external_id;
+
+     //shortest path trees of the sources given to TrackSource, indexed by the ids
+     //the caller gave, and the scratch space used to repair them
+     std::vector<DijkstraTree> tracked_trees;
+     std::vector<AdjacencyInfo> repair_heap;
+     std::vector<unsigned> repair_nodes;
+     std::vector<bool> in_repair;
 };
 #endif
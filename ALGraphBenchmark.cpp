@@ -0,0 +1,497 @@
+/*
+    ALGraph benchmark over generated graph families.
+
+    Builds every graph family at every size, then times building the graph, GetAList
+    and Dijkstra with every storage layout and priority queue strategy, printing one
+    JSON object per line:
+
+    {"graph":"grid","nodes":250000,"edges":998000,"max_weight":10,"operation":"dijkstra",
+     "layout":"frozen","strategy":"dial","resolved":"dial","repeats":20,"mean_ms":...,
+     "ns_per_edge":...,"allocations":...,"peak_heap_bytes":...,"peak_rss_kb":...,"checksum":...}
+
+    grid        4-connected grid, small weights 1..10, where Dial's buckets shine
+    random      Erdos-Renyi style, 4 directed edges per node between random nodes,
+                weights 1..100, added with AddDEdge
+    scale_free  Barabasi-Albert, every new node joins 3 nodes picked by degree, so a
+                few hubs get very long adjacency lists, weights 1..100
+    road        jittered grid of intersections joined to nearby ones, weights are
+                lengths in centimetres (up to a few thousand), so AUTO picks the radix heap
+
+    Every graph except random is undirected and added with AddUEdge.
+
+    operations
+    add_edge        one AddDEdge/AddUEdge call per edge into an empty graph
+    add_edges       the same edges through AddDEdges/AddUEdges
+    freeze          Freeze of the built graph
+    reorder_rcm     Reorder(NodeOrder::REVERSE_CUTHILL_MCKEE) of the frozen graph
+    get_alist       one GetAList copy
+    dijkstra        Dijkstra from fixed sources into a reused workspace
+    delta_stepping  DeltaStepping with the given thread count on the frozen graph
+
+    layouts are lists (adjacency lists), frozen (compressed sparse row) and frozen_rcm
+    (compressed sparse row after reordering).
+
+    ns_per_edge divides the time by the stored edges (undirected edges count twice)
+    times the repeats. allocations and peak_heap_bytes count operator new over the
+    timed part only, peak_rss_kb is the peak of the whole process so far.
+
+    checksum is the sum of every reachable cost for searches, it has to be the same
+    for every layout and strategy of a graph. Graphs and sources come from a fixed seed.
+
+    Build:
+        g++ -std=c++17 -O2 ALGraphBenchmark.cpp ALGraph.cpp -o algraph_benchmark -pthread
+
+    Usage:
+        algraph_benchmark [--sizes 10000,100000] [--queries 10] [--threads 0] [--seed 1] [--out results.jsonl]
+
+    --threads 0 uses one thread per hardware thread.
+*/
+#include "ALGraph.h"
+#include "BenchmarkCommon.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+namespace {
+
+    //every allocation is prefixed with its size, so frees can be taken off the live total
+    const std::size_t allocation_header = alignof(std::max_align_t);
+    std::atomic<unsigned long long> allocation_count(0);
+    std::atomic<unsigned long long> live_bytes(0);
+    std::atomic<unsigned long long> peak_bytes(0);
+
+    void* counted_alloc(std::size_t size) {
+        unsigned char* block = static_cast<unsigned char*>(std::malloc(size + allocation_header));
+        if (!block) {
+            return nullptr;
+        }
+        *reinterpret_cast<std::size_t*>(block) = size;
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        unsigned long long live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        unsigned long long peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+        return block + allocation_header;
+    }
+
+    void counted_free(void* pointer) {
+        if (!pointer) {
+            return;
+        }
+        unsigned char* block = static_cast<unsigned char*>(pointer) - allocation_header;
+        live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+        std::free(block);
+    }
+
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = counted_alloc(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    void* pointer = counted_alloc(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    counted_free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    counted_free(pointer);
+}
+
+namespace {
+
+    const unsigned unreachable = static_cast<unsigned>(-1);
+
+    struct BenchmarkGraph {
+        std::string name;
+        unsigned nodes;
+        bool directed;
+        unsigned max_weight;
+        std::vector<EdgeInfo> edges;
+
+        //undirected edges are stored twice
+        unsigned long long stored_edges() const {
+            return directed ? edges.size() : 2ull * edges.size();
+        }
+    };
+
+    //time, allocations and heap peak of one timed part
+    struct Usage {
+        double total_ms;
+        unsigned long long allocations;
+        unsigned long long peak_heap_bytes;
+    };
+
+    //starts counting when made, the heap peak is measured from the live heap at that point
+    class Meter {
+    public:
+        Meter() : begin(std::chrono::steady_clock::now()),
+            start_allocations(allocation_count.load()), start_live(live_bytes.load()) {
+            peak_bytes.store(start_live);
+        }
+
+        Usage stop() const {
+            return stop(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+        }
+
+        //for parts that time themselves and leave untimed work out
+        Usage stop(double total_ms) const {
+            Usage usage;
+            usage.total_ms = total_ms;
+            usage.allocations = allocation_count.load() - start_allocations;
+            usage.peak_heap_bytes = peak_bytes.load() - start_live;
+            return usage;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point begin;
+        unsigned long long start_allocations;
+        unsigned long long start_live;
+    };
+
+    using bench::peak_rss_kb;
+    using bench::random_below;
+
+    unsigned grid_side(unsigned nodes) {
+        unsigned side = static_cast<unsigned>(std::sqrt(static_cast<double>(nodes)));
+        return side < 2 ? 2 : side;
+    }
+
+    void set_max_weight(BenchmarkGraph& graph) {
+        graph.max_weight = 0;
+        for (const EdgeInfo& edge : graph.edges) {
+            graph.max_weight = edge.weight > graph.max_weight ? edge.weight : graph.max_weight;
+        }
+    }
+
+    BenchmarkGraph build_grid(unsigned nodes, std::mt19937& rng) {
+        BenchmarkGraph graph;
+        const unsigned side = grid_side(nodes);
+        graph.name = "grid";
+        graph.nodes = side * side;
+        graph.directed = false;
+
+        for (unsigned row = 0; row < side; ++row) {
+            for (unsigned col = 0; col < side; ++col) {
+                unsigned node = row * side + col + 1;
+                if (col + 1 < side) {
+                    graph.edges.push_back({ node, node + 1, 1 + random_below(rng, 10) });
+                }
+                if (row + 1 < side) {
+                    graph.edges.push_back({ node, node + side, 1 + random_below(rng, 10) });
+                }
+            }
+        }
+        set_max_weight(graph);
+        return graph;
+    }
+
+    BenchmarkGraph build_random(unsigned nodes, std::mt19937& rng) {
+        BenchmarkGraph graph;
+        graph.name = "random";
+        graph.nodes = nodes < 2 ? 2 : nodes;
+        graph.directed = true;
+
+        //a fixed edge count instead of a coin flip per pair, the same average degree
+        const unsigned long long edge_count = 4ull * graph.nodes;
+        graph.edges.reserve(edge_count);
+        for (unsigned long long i = 0; i < edge_count; ++i) {
+            unsigned source = 1 + random_below(rng, graph.nodes);
+            unsigned destination = 1 + random_below(rng, graph.nodes);
+            graph.edges.push_back({ source, destination, 1 + random_below(rng, 100) });
+        }
+        set_max_weight(graph);
+        return graph;
+    }
+
+    BenchmarkGraph build_scale_free(unsigned nodes, std::mt19937& rng) {
+        const unsigned links = 3;
+        BenchmarkGraph graph;
+        graph.name = "scale_free";
+        graph.nodes = nodes < links + 1 ? links + 1 : nodes;
+        graph.directed = false;
+
+        //every edge end is listed once, so a uniform pick from it is a pick by degree
+        std::vector<unsigned> ends;
+        ends.reserve(2ull * links * graph.nodes);
+        for (unsigned node = 2; node <= links + 1; ++node) {
+            graph.edges.push_back({ 1, node, 1 + random_below(rng, 100) });
+            ends.push_back(1);
+            ends.push_back(node);
+        }
+        for (unsigned node = links + 2; node <= graph.nodes; ++node) {
+            for (unsigned link = 0; link < links; ++link) {
+                unsigned other = ends[random_below(rng, static_cast<unsigned>(ends.size()))];
+                graph.edges.push_back({ node, other, 1 + random_below(rng, 100) });
+                ends.push_back(node);
+                ends.push_back(other);
+            }
+        }
+        set_max_weight(graph);
+        return graph;
+    }
+
+    BenchmarkGraph build_road(unsigned nodes, std::mt19937& rng) {
+        BenchmarkGraph graph;
+        const unsigned side = grid_side(nodes);
+        graph.name = "road";
+        graph.nodes = side * side;
+        graph.directed = false;
+
+        //intersections sit near the grid points, 10m apart on average
+        std::vector<double> x(graph.nodes), y(graph.nodes);
+        for (unsigned i = 0; i < graph.nodes; ++i) {
+            x[i] = (i % side) * 10.0 + random_below(rng, 600) / 100.0;
+            y[i] = (i / side) * 10.0 + random_below(rng, 600) / 100.0;
+        }
+        auto length_cm = [&](unsigned a, unsigned b) {
+            double dx = x[a] - x[b];
+            double dy = y[a] - y[b];
+            return static_cast<unsigned>(std::sqrt(dx * dx + dy * dy) * 100.0) + 1;
+        };
+
+        //most streets exist, a few are missing and a few diagonal shortcuts are added
+        for (unsigned row = 0; row < side; ++row) {
+            for (unsigned col = 0; col < side; ++col) {
+                unsigned i = row * side + col;
+                if (col + 1 < side && random_below(rng, 100) < 85) {
+                    graph.edges.push_back({ i + 1, i + 2, length_cm(i, i + 1) });
+                }
+                if (row + 1 < side && random_below(rng, 100) < 85) {
+                    graph.edges.push_back({ i + 1, i + side + 1, length_cm(i, i + side) });
+                }
+                if (row + 1 < side && col + 1 < side && random_below(rng, 100) < 10) {
+                    graph.edges.push_back({ i + 1, i + side + 2, length_cm(i, i + side + 1) });
+                }
+            }
+        }
+        set_max_weight(graph);
+        return graph;
+    }
+
+    const char* strategy_name(QueueStrategy strategy) {
+        switch (strategy) {
+        case QueueStrategy::AUTO: return "auto";
+        case QueueStrategy::BINARY_HEAP: return "binary_heap";
+        case QueueStrategy::DIAL: return "dial";
+        case QueueStrategy::RADIX_HEAP: return "radix_heap";
+        }
+        return "unknown";
+    }
+
+    void print_result(std::ostream& out, const BenchmarkGraph& input, const char* operation, const char* layout,
+                      const char* strategy, const char* resolved, unsigned repeats, const Usage& usage,
+                      unsigned long long checksum) {
+        double edges = static_cast<double>(input.stored_edges()) * repeats;
+        out << "{\"graph\":\"" << input.name << "\",\"nodes\":" << input.nodes
+            << ",\"edges\":" << input.stored_edges() << ",\"max_weight\":" << input.max_weight
+            << ",\"operation\":\"" << operation << "\""
+            << ",\"layout\":\"" << layout << "\""
+            << ",\"strategy\":\"" << strategy << "\""
+            << ",\"resolved\":\"" << resolved << "\""
+            << ",\"repeats\":" << repeats << ",\"mean_ms\":" << usage.total_ms / repeats
+            << ",\"ns_per_edge\":" << (edges > 0 ? usage.total_ms * 1e6 / edges : 0.0)
+            << ",\"allocations\":" << usage.allocations
+            << ",\"peak_heap_bytes\":" << usage.peak_heap_bytes
+            << ",\"peak_rss_kb\":" << peak_rss_kb()
+            << ",\"checksum\":" << checksum << "}\n";
+    }
+
+    unsigned long long sum_costs(const std::vector<unsigned>& costs) {
+        unsigned long long checksum = 0;
+        for (unsigned cost : costs) {
+            checksum += cost == unreachable ? 0 : cost;
+        }
+        return checksum;
+    }
+
+    void add_edges_one_by_one(ALGraph& graph, const BenchmarkGraph& input) {
+        for (const EdgeInfo& edge : input.edges) {
+            if (input.directed) {
+                graph.AddDEdge(edge.source, edge.destination, edge.weight);
+            }
+            else {
+                graph.AddUEdge(edge.source, edge.destination, edge.weight);
+            }
+        }
+    }
+
+    void time_get_alist(const ALGraph& graph, const BenchmarkGraph& input, const char* layout, std::ostream& out) {
+        Meter meter;
+        ALIST list = graph.GetAList();
+        Usage usage = meter.stop();
+
+        unsigned long long checksum = 0;
+        for (const auto& adjacency : list) {
+            for (const AdjacencyInfo& info : adjacency) {
+                checksum += info.weight;
+            }
+        }
+        print_result(out, input, "get_alist", layout, "none", "none", 1, usage, checksum);
+    }
+
+    void time_dijkstra(ALGraph& graph, const BenchmarkGraph& input, const char* layout,
+                       const std::vector<unsigned>& sources, std::ostream& out) {
+        const QueueStrategy strategies[] = {
+            QueueStrategy::BINARY_HEAP, QueueStrategy::DIAL, QueueStrategy::RADIX_HEAP, QueueStrategy::AUTO
+        };
+        for (QueueStrategy strategy : strategies) {
+            graph.SetQueueStrategy(strategy);
+
+            //one warm up run so the workspace is already allocated when timing starts
+            DijkstraWorkspace workspace;
+            graph.Dijkstra(sources[0], workspace);
+
+            //checksums are summed outside the timed part, the same as for delta stepping
+            Meter meter;
+            unsigned long long checksum = 0;
+            double total_ms = 0.0;
+            for (unsigned source : sources) {
+                auto begin = std::chrono::steady_clock::now();
+                graph.Dijkstra(source, workspace);
+                total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                checksum += sum_costs(workspace.dist);
+            }
+            print_result(out, input, "dijkstra", layout, strategy_name(strategy), strategy_name(graph.GetQueueStrategy()),
+                static_cast<unsigned>(sources.size()), meter.stop(total_ms), checksum);
+        }
+        graph.SetQueueStrategy(QueueStrategy::BINARY_HEAP);
+    }
+
+    void run_graph(const BenchmarkGraph& input, unsigned query_count, unsigned thread_count, unsigned seed, std::ostream& out) {
+        {
+            Meter meter;
+            ALGraph graph(input.nodes);
+            add_edges_one_by_one(graph, input);
+            print_result(out, input, "add_edge", "lists", "none", "none", 1, meter.stop(), 0);
+        }
+
+        ALGraph graph(input.nodes);
+        {
+            Meter meter;
+            if (input.directed) {
+                graph.AddDEdges(input.edges);
+            }
+            else {
+                graph.AddUEdges(input.edges);
+            }
+            print_result(out, input, "add_edges", "lists", "none", "none", 1, meter.stop(), 0);
+        }
+
+        std::mt19937 rng(seed);
+        std::vector<unsigned> sources(query_count);
+        for (unsigned& source : sources) {
+            source = 1 + random_below(rng, input.nodes);
+        }
+
+        time_get_alist(graph, input, "lists", out);
+        time_dijkstra(graph, input, "lists", sources, out);
+
+        {
+            Meter meter;
+            graph.Freeze();
+            print_result(out, input, "freeze", "frozen", "none", "none", 1, meter.stop(), 0);
+        }
+        time_get_alist(graph, input, "frozen", out);
+        time_dijkstra(graph, input, "frozen", sources, out);
+
+        unsigned long long checksum = 0;
+        Meter meter;
+        double total_ms = 0.0;
+        for (unsigned source : sources) {
+            auto begin = std::chrono::steady_clock::now();
+            std::vector<unsigned> costs = graph.DeltaStepping(source, 0, thread_count);
+            total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            checksum += sum_costs(costs);
+        }
+        print_result(out, input, "delta_stepping", "frozen", "delta_stepping", "delta_stepping", query_count,
+            meter.stop(total_ms), checksum);
+
+        {
+            Meter reorder_meter;
+            graph.Reorder(NodeOrder::REVERSE_CUTHILL_MCKEE);
+            print_result(out, input, "reorder_rcm", "frozen_rcm", "none", "none", 1, reorder_meter.stop(), 0);
+        }
+        time_get_alist(graph, input, "frozen_rcm", out);
+        time_dijkstra(graph, input, "frozen_rcm", sources, out);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<unsigned> sizes = { 10000, 100000 };
+    unsigned query_count = 10;
+    unsigned thread_count = 0;
+    unsigned seed = 1;
+    std::string out_file;
+
+    if (!bench::parse_options(argc, argv, {
+            { "--sizes", bench::set_unsigned_list(sizes) },
+            { "--queries", bench::set_unsigned(query_count) },
+            { "--threads", bench::set_unsigned(thread_count) },
+            { "--seed", bench::set_unsigned(seed) },
+            { "--out", bench::set_string(out_file) } },
+            "[--sizes 10000,100000] [--queries 10] [--threads 0] [--seed 1] [--out file]")) {
+        return 1;
+    }
+    if (query_count == 0) {
+        query_count = 1;
+    }
+
+    bench::Output output;
+    if (!output.open(out_file)) {
+        return 1;
+    }
+    std::ostream& out = output.stream();
+
+    std::mt19937 rng(seed);
+    for (unsigned size : sizes) {
+        run_graph(build_grid(size, rng), query_count, thread_count, seed, out);
+        run_graph(build_random(size, rng), query_count, thread_count, seed, out);
+        run_graph(build_scale_free(size, rng), query_count, thread_count, seed, out);
+        run_graph(build_road(size, rng), query_count, thread_count, seed, out);
+    }
+    return 0;
+}
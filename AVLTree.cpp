@@ -26,38 +26,21 @@
 
     /*!
       \brief
-      function to calculate balance factor of a node
+      function to get the balance factor of a node, kept up to date by insert,
+      remove and the rotations instead of being worked out from tree heights
 
       \param node_ptr
-        node to be calculated
+        node to be checked
 
       \return
-      returns balance factor of the node
+      returns height of left subtree - height of right subtree
     */
     template<typename T>
     int AVLTree<T>::calculate_bf(typename AVLTree<T>::BinTreeNode* node_ptr){
-
-            //there is left child and right child
-            if(node_ptr->left && node_ptr->right){
-                node_ptr->balance_factor = BSTree<T>::tree_height(node_ptr->left) - BSTree<T>::tree_height(node_ptr->right);
-            }
-
-            //only have left child
-            else if(node_ptr->left && !node_ptr->right){
-                node_ptr->balance_factor = BSTree<T>::tree_height(node_ptr->left);
-            }
-
-            //only have right child
-            else if(!node_ptr->left && node_ptr->right){
-                node_ptr->balance_factor = -BSTree<T>::tree_height(node_ptr->right);
+            //empty subtree, bf = 0
+            if(!node_ptr){
+                return 0;
             }
-
-            //no child, bf = 0
-            else{
-                node_ptr->balance_factor = 0;
-            }
-
-            //return bf of node
             return node_ptr->balance_factor;
     }
 
@@ -90,6 +73,11 @@
 
         node_ptr->right = temp;
         node_ptr->count += (temp->count);
+
+        //update balance factors, temp lost its left child's left side and node_ptr
+        //gained temp on its right
+        temp->balance_factor = temp->balance_factor - 1 - std::max(node_ptr->balance_factor, 0);
+        node_ptr->balance_factor = node_ptr->balance_factor - 1 + std::min(temp->balance_factor, 0);
     }
 
     /*!
@@ -121,162 +109,135 @@
 
         node_ptr->left = temp;
         node_ptr->count += (temp->count);
+
+        //update balance factors, mirror of rotate_right
+        temp->balance_factor = temp->balance_factor + 1 - std::min(node_ptr->balance_factor, 0);
+        node_ptr->balance_factor = node_ptr->balance_factor + 1 + std::max(temp->balance_factor, 0);
     }
 
 
     /*!
       \brief
-      function to insert a node into AVLTree
+      function to rebalance a node whose balance factor is 2 or -2, with one
+      or two rotations
 
-      \param value
-        value to be inserted
+      \param node_ptr
+        node to be balanced, set to the new root of the subtree
 
       \return
       none
     */
     template<typename T>
-    void AVLTree<T>::insert(const T& value){
-        try{
+    void AVLTree<T>::balance_node(typename AVLTree<T>::BinTreeNode*& node_ptr){
+        if(node_ptr->balance_factor > 1){
 
-            //keep track of the visited nodes when we are inserting
-            std::stack<typename AVLTree<T>::BinTreeNode**> visited_nodes;
-            int number_of_recursions = 0;
-            typename BSTree<T>::BinTreeNode*& root_node = BSTree<T>::get_root();
-
-            //root is nullptr, create root node
-            if(root_node == nullptr){
-                root_node = BSTree<T>::make_node(value);
-                root_node->count = 1;
-            }
-            
-            //recursively call
-            else if(value < root_node->data){
-                insert_node(root_node, root_node->left, visited_nodes, value, number_of_recursions);
+            //case 1: left-left, right rotation
+            if(calculate_bf(node_ptr->left) >= 0){
+                rotate_right(node_ptr);
             }
 
-            //recursively call
-            else if(value > root_node->data){
-                insert_node(root_node, root_node->right, visited_nodes, value, number_of_recursions);
+            //case 2: left-right, left-right rotation
+            else{
+                rotate_left(node_ptr->left);
+                rotate_right(node_ptr);
             }
-            
-
-            //insert_node has successfully inserted a node, we go through the stack of visited nodes
-            //and calculate each node's new balance factor
-            while(visited_nodes.size()){
-                typename AVLTree<T>::BinTreeNode**& top = visited_nodes.top();
-                calculate_bf(*top);
-
-
-                //bf >= -1 and bf <= 1, no need to do any balancing
-                if((*top)->balance_factor >= -1 && (*top)->balance_factor <= 1){
-                    visited_nodes.pop();
-                    continue;
-                }
-
-                //balancing needed to be done
-                else{
-
-                    if((*top)->balance_factor>1){
-                        
-                        //case 1: left-left, right rotation
-                        if(calculate_bf((*top)->left)>=0){
-                            rotate_right((*top));
-                        }
-
-                        //case 2: left-right, left-right rotation
-                        else{
-                            rotate_left((*top)->left);
-                            rotate_right((*top));
-                        }
-                        
-                    }
-
-                    else if((*top)->balance_factor< -1){
-
-                        //case 3: right-right, left rotation
-                        if(calculate_bf((*top)->right) <= 0){
-                            rotate_left((*top));
-                        }
+        }
 
-                        //case 4: right-left, right-left rotation
-                        else{
-                            rotate_right((*top)->right);
-                            rotate_left((*top));
-                        }
-                    }
-                    
-                    //once a node is rebalanced, we do not need to check subsequent visited nodes
-                    break;
-                }
+        else if(node_ptr->balance_factor < -1){
 
+            //case 3: right-right, left rotation
+            if(calculate_bf(node_ptr->right) <= 0){
+                rotate_left(node_ptr);
             }
 
-        } catch (const std::exception& e){
-            throw(BSTException(OAException::OA_EXCEPTION::E_NO_MEMORY, e.what()));
+            //case 4: right-left, right-left rotation
+            else{
+                rotate_right(node_ptr->right);
+                rotate_left(node_ptr);
+            }
         }
     }
 
-
     /*!
       \brief
-      function that is recursively called by insert()
-
-      \param parent
-      parent ndoe
-
-      \param node_ptr
-      child node
-
-      \param visited_nodes
-      reference to stack of visited nodes
+      function to insert a node into AVLTree. walks down without recursion,
+      keeping the path in an array on the stack, so nothing but the new node
+      is allocated
 
-      \param number_of_recursions
-      number of times function is recursively called
+      \param value
+        value to be inserted
 
       \return
       none
     */
     template<typename T>
-    void AVLTree<T>::insert_node(typename AVLTree<T>::BinTreeNode*& parent, typename AVLTree<T>::BinTreeNode*& node_ptr,std::stack<typename AVLTree<T>::BinTreeNode**>& visited_nodes, T value, int& number_of_recursions){
-            ++number_of_recursions;
-            visited_nodes.push(&parent);
-        
-            //create node here
-            if(node_ptr == nullptr){
-                
-                node_ptr = BSTree<T>::make_node(value);
-                node_ptr->left = nullptr;
-                node_ptr->right = nullptr;
-                if(value < parent->data){
-                    parent->left = node_ptr;
+    void AVLTree<T>::insert(const T& value){
+        try{
+
+            //links leading to every node on the way down, path[0] is the root link
+            typename AVLTree<T>::BinTreeNode** path[MAX_PATH];
+            int depth = 0;
+
+            typename AVLTree<T>::BinTreeNode** link = &BSTree<T>::get_root();
+            while(*link != nullptr){
+                path[depth++] = link;
+
+                //havent reached the spot to insert node at
+                if(value < (*link)->data){
+                    link = &(*link)->left;
                 }
-                else if(value > parent->data){
-                    parent->right = node_ptr;
+                else if(value > (*link)->data){
+                    link = &(*link)->right;
                 }
 
-                node_ptr->count = 1;
-                BSTree<T>::get_root()->count += 1;
+                //value already in the tree, nothing changes
+                else{
+                    return;
+                }
             }
 
-            //havent reached the spot to insert node at
-            else if(value < node_ptr->data){
-                node_ptr->count += 1;
-                insert_node(node_ptr, node_ptr->left,visited_nodes, value, number_of_recursions);
+            //create node here
+            typename AVLTree<T>::BinTreeNode* node_ptr = BSTree<T>::make_node(value);
+            node_ptr->left = nullptr;
+            node_ptr->right = nullptr;
+            node_ptr->count = 1;
+            node_ptr->balance_factor = 0;
+            *link = node_ptr;
+
+            for(int i = 0; i < depth; ++i){
+                (*path[i])->count += 1;
             }
 
-            //havent reached the spot to insert node at
-            else if(value > node_ptr->data){
-                node_ptr->count += 1;
-                insert_node(node_ptr, node_ptr->right,visited_nodes, value, number_of_recursions);
-            }
-            else{
+            //go back up fixing balance factors until a subtree stops getting taller
+            typename AVLTree<T>::BinTreeNode* child = node_ptr;
+            for(int i = depth - 1; i >= 0; --i){
+                typename AVLTree<T>::BinTreeNode*& top = *path[i];
+                top->balance_factor += (child == top->left) ? 1 : -1;
+
+                //the subtree was uneven before and is even now, same height as before
+                if(top->balance_factor == 0){
+                    break;
+                }
+
+                //a rotation after an insert always brings the subtree back to the height it
+                //had before, so nodes further up do not change
+                if(top->balance_factor > 1 || top->balance_factor < -1){
+                    balance_node(top);
+                    break;
+                }
+                child = top;
             }
+
+        } catch (const std::exception& e){
+            throw(BSTException(OAException::OA_EXCEPTION::E_NO_MEMORY, e.what()));
+        }
     }
 
 
     /*!
       \brief
-      function to remove a node
+      function to remove a node. walks down without recursion, keeping the path
+      in an array on the stack, so nothing is allocated
 
       \param value
       value to be removed from AVLTree
@@ -287,297 +248,186 @@
     template<typename T>
     void AVLTree<T>::remove(const T& value){
 
-            //similarly to insert, we also keep track of traversed nodes
-            std::stack<typename AVLTree<T>::BinTreeNode**> visited_nodes;
-            
-            typename BSTree<T>::BinTreeNode*& root_node = BSTree<T>::get_root();
+            //links leading to every node on the way down, path[0] is the root link
+            typename AVLTree<T>::BinTreeNode** path[MAX_PATH];
+            int depth = 0;
 
-            if(!root_node){
-                return;
-            }
+            typename AVLTree<T>::BinTreeNode** link = &BSTree<T>::get_root();
+            while(*link != nullptr && !(value == (*link)->data)){
+                path[depth++] = link;
 
-            //found match right at the start
-            if(value == root_node->data){
-                BSTree<T>::free_node(root_node);
-                BSTree<T>::get_root() = nullptr;
+                //havent found value yet
+                if(value < (*link)->data){
+                    link = &(*link)->left;
+                }
+                else{
+                    link = &(*link)->right;
+                }
+            }
 
+            //value not found
+            if(*link == nullptr){
+                return;
             }
 
-            //recursively call
-            else if(value < root_node->data){
-                remove_node(root_node, root_node->left, visited_nodes, value);
+            //Case 1: Node to be deleted has 2 children, take the value of its predecessor,
+            //the largest node of its own left subtree, and remove the predecessor instead
+            typename AVLTree<T>::BinTreeNode* node_ptr = *link;
+            if(node_ptr->left && node_ptr->right){
+                path[depth++] = link;
+                link = &node_ptr->left;
+                while((*link)->right != nullptr){
+                    path[depth++] = link;
+                    link = &(*link)->right;
+                }
+                node_ptr->data = (*link)->data;
             }
 
-            //recursively call
-            else if(value > root_node->data){
-                remove_node(root_node, root_node->right, visited_nodes, value);
+            //Case 2: Node to be deleted has at most one child, which takes its place
+            typename AVLTree<T>::BinTreeNode* tmp = *link;
+            *link = tmp->left ? tmp->left : tmp->right;
+            BSTree<T>::free_node(tmp);
+
+            for(int i = 0; i < depth; ++i){
+                (*path[i])->count -= 1;
             }
 
+            //go back up fixing balance factors until a subtree stops getting shorter
+            typename AVLTree<T>::BinTreeNode** shorter = link;
+            for(int i = depth - 1; i >= 0; --i){
+                typename AVLTree<T>::BinTreeNode*& top = *path[i];
+                top->balance_factor += (shorter == &top->left) ? -1 : 1;
 
-            //if code reaches here, node to be deleted has been found
-            while(visited_nodes.size()){
-                typename AVLTree<T>::BinTreeNode**& top = visited_nodes.top();
-                calculate_bf(*top);
-                if((*top)->balance_factor >= -1 && (*top)->balance_factor <= 1){
-                    visited_nodes.pop();
-                    continue;
+                //the subtree was balanced before, the other side still holds its height
+                if(top->balance_factor == 1 || top->balance_factor == -1){
+                    break;
                 }
-                else{
 
-                    if((*top)->balance_factor>1){
-                        
-                        //case 1: left-left, right rotation
-                        if(calculate_bf((*top)->left)>=0){
-                            rotate_right((*top));
-                        }
-
-                        //case 2: left-right, left-right rotation
-                        else{
-                            rotate_left((*top)->left);
-                            rotate_right((*top));
-                        }
-                        
+                //after a rotation the subtree is shorter unless the taller child was balanced
+                if(top->balance_factor != 0){
+                    balance_node(top);
+                    if(top->balance_factor != 0){
+                        break;
                     }
-
-                    else if((*top)->balance_factor< -1){
-
-                        //case 3: right-right, left rotation
-                        if(calculate_bf((*top)->right) <= 0){
-                            rotate_left((*top));
-                        }
-
-                        //case 4: right-left, right-left rotation
-                        else{
-                            rotate_right((*top)->right);
-                            rotate_left((*top));
-                        }
-                    }   
-                    visited_nodes.pop();
                 }
+                shorter = path[i];
             }
     }
 
+
     /*!
       \brief
-      function that is recursively called by remove()
-
-      \param parent
-      parent ndoe
-
-      \param node_ptr
-      child node
-
-      \param visited_nodes
-      reference to stack of visited nodes
+      function to find the node holding the k-th smallest value, going down
+      one path by the count of each left subtree
 
-      \param number_of_recursions
-      number of times function is recursively called
+      \param k
+        0 based position of the value in sorted order
 
       \return
-      none
+      returns the node at position k, or nullptr if k is not less than size()
     */
     template<typename T>
-    void AVLTree<T>::remove_node(typename AVLTree<T>::BinTreeNode*& parent, typename AVLTree<T>::BinTreeNode*& node_ptr,std::stack<typename AVLTree<T>::BinTreeNode**>& visited_nodes, T value) {
+    const typename AVLTree<T>::BinTreeNode* AVLTree<T>::select(unsigned k) const{
+        const typename AVLTree<T>::BinTreeNode* node_ptr = BSTree<T>::root();
+        while(node_ptr != nullptr){
+            unsigned left_count = node_ptr->left ? node_ptr->left->count : 0;
+
+            //k is inside the left subtree
+            if(k < left_count){
+                node_ptr = node_ptr->left;
+            }
 
-        visited_nodes.push(&parent);
-        if(node_ptr == nullptr){
-        //  std::cout <<"value " <<value <<" not found\n";
+            //skip the left subtree and this node
+            else if(k > left_count){
+                k -= left_count + 1;
+                node_ptr = node_ptr->right;
+            }
+            else{
+                return node_ptr;
+            }
         }
-
-        else if(node_ptr->data == value){
-                //Case 1: Node to be deleted has 2 children, find node's predecessor
-                if(node_ptr->left && node_ptr->right){
-                    typename AVLTree<T>::BinTreeNode* root_node = BSTree<T>::root();
-                    typename AVLTree<T>::BinTreeNode* predecessor = root_node->left;
-                    typename AVLTree<T>::BinTreeNode* parent_of_predecessor=root_node;
-
-                    while(predecessor->right != nullptr){
-                        predecessor->count -= 1;
-                        parent_of_predecessor = predecessor;
-                        predecessor = predecessor->right;
-                    }
-
-                    
-
-                    //predecessor has been found, replace node to be deleted value
-                    node_ptr->data = predecessor->data;
-
-                    //now, we need to delete the node that has the predecessor
-                    //this node is guaranteed to either be leaf node, or node with empty right child
-                        visited_nodes.push(&node_ptr);
-                    //if node is leaf node, simply delete
-                    if(predecessor->left ==nullptr && predecessor->right == nullptr){
-                        if(parent_of_predecessor!=root_node){
-                            if(predecessor->data < parent_of_predecessor->data){
-                            parent_of_predecessor->left = nullptr;
-                            }
-                        
-                            else{
-                                parent_of_predecessor->right = nullptr;
-                            }
-                        }
-
-                        if(node_ptr->right){
-                            if(node_ptr->data > node_ptr->right->data){
-                                node_ptr->right->left = node_ptr->left;
-                                if(node_ptr->left){
-                                    node_ptr->right->count += (node_ptr->left->count);
-                                }
-                                node_ptr->left = node_ptr->right;
-                                node_ptr->right = nullptr;
-                                
-                            }
-                        }
-
-                        //free node
-                        BSTree<T>::free_node(predecessor);
-
-                        predecessor= nullptr;
-                    }
-
-                    //else if node has left child
-                    else if(predecessor->left !=nullptr){
-                        if(parent_of_predecessor!=root_node){
-                            parent_of_predecessor->right = predecessor->left;
-                        }
-
-                        //if parent of predecessor is root node itself, it means we did not
-                        //even enter the while loop, which means that the parent
-                        //must be the root node itself, it also means that the predecessor
-                        //would be the immediate left child of root node, and the next highest
-                        //node would be the left child of the immediate left child 
-                        else{
-                            root_node->left = predecessor->left;
-                        }
-                        BSTree<T>::free_node(predecessor);
-                        predecessor= nullptr;
-
-                    }
-                    root_node->count -= 1;
-                }
-
-                //node to be removed has left child and no right child
-                else if(node_ptr->left && !node_ptr->right){
-
-                    typename AVLTree<T>::BinTreeNode* tmp3 = BSTree<T>::root();
-                    typename AVLTree<T>::BinTreeNode* parent_node3 =BSTree<T>::root();
-
-                    //decrement count value of all parents of the node to be deleted
-                    while(tmp3 != nullptr && value != tmp3->data){
-                        if(value < tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->left;
-                        }
-                        else if(value > tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->right;
-                        }
-                        parent_node3->count -= 1;
-
-                    }
+        return nullptr;
+    }
 
 
-                    typename AVLTree<T>::BinTreeNode* tmp2 = node_ptr;
-                    if(node_ptr ==BSTree<T>::get_root()){
-                        BSTree<T>::get_root() = node_ptr->left;
-                    }
-                    node_ptr = node_ptr->left;
-                    BSTree<T>::free_node(tmp2);
-                    if( node_ptr->data < parent->data){
-                        parent->left = node_ptr;
-                    }
-                    else if(node_ptr->data > parent->data){
-                        parent->right = node_ptr;
-                    }
+    /*!
+      \brief
+      function to get the number of values in the tree smaller than a value,
+      which is the position the value has or would have in sorted order
 
-                    tmp2= nullptr;
-                }
+      \param value
+        value to be ranked, does not need to be in the tree
 
-                //node to be removed has right child and no left child
-                else if(node_ptr->right && !node_ptr->left){
-
-                    typename AVLTree<T>::BinTreeNode* tmp3 = BSTree<T>::root();
-                    typename AVLTree<T>::BinTreeNode* parent_node3 =BSTree<T>::root();
-
-                    //decrement count value of all parents of the node to be deleted
-                    while(tmp3 != nullptr && value != tmp3->data){
-                        if(value < tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->left;
-                        }
-                        else if(value > tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->right;
-                        }
-                        parent_node3->count -= 1;
-                    }
+      \return
+      returns the number of values less than value
+    */
+    template<typename T>
+    unsigned AVLTree<T>::rank(const T& value) const{
+        unsigned result = 0;
+        const typename AVLTree<T>::BinTreeNode* node_ptr = BSTree<T>::root();
+        while(node_ptr != nullptr){
+            if(node_ptr->data < value){
+
+                //this node and its whole left subtree are smaller
+                result += (node_ptr->left ? node_ptr->left->count : 0) + 1;
+                node_ptr = node_ptr->right;
+            }
+            else{
+                node_ptr = node_ptr->left;
+            }
+        }
+        return result;
+    }
 
-                    typename AVLTree<T>::BinTreeNode* tmp2 = node_ptr;
-                    if(node_ptr == BSTree<T>::get_root()){
-                        BSTree<T>::get_root() = node_ptr->right;
-                    }
-                    node_ptr = node_ptr->right;
-                    BSTree<T>::free_node(tmp2);
-                    if( node_ptr->data < parent->data){
-                        parent->left = node_ptr;
-                    }
-                    else if(node_ptr->data > parent->data){
-                        parent->right = node_ptr;
-                    }
 
-                    tmp2= nullptr;
-                }
+    /*!
+      \brief
+      function to count the values between two bounds without visiting them
 
-                //node to be removed is a leaf node
-                else if(!node_ptr->left && !node_ptr->right){
-                        //            std::cout <<"no child\n";
-                    typename AVLTree<T>::BinTreeNode* tmp3 = BSTree<T>::root();
-                    typename AVLTree<T>::BinTreeNode* parent_node3 =BSTree<T>::root();
-
-                    //decrement count value of all parents of the node to be deleted
-                    while(tmp3 != nullptr && value != tmp3->data){
-                        if(value < tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->left;
-                        }
-                        else if(value > tmp3->data){
-                            parent_node3 = tmp3;
-                            tmp3 = tmp3->right;
-                        }
-                        parent_node3->count -= 1;
+      \param lo
+        lowest value counted
 
-                    }
+      \param hi
+        highest value counted
 
-                    if( node_ptr->data < parent->data){
-                        parent->left = nullptr;
-                    }
-                    else if(node_ptr->data > parent->data){
-                        parent->right = nullptr;
-                    }
+      \return
+      returns the number of values v with lo <= v <= hi, 0 if hi < lo
+    */
+    template<typename T>
+    unsigned AVLTree<T>::count_range(const T& lo, const T& hi) const{
+        if(hi < lo){
+            return 0;
+        }
+        return count_not_greater(hi) - rank(lo);
+    }
 
-                    BSTree<T>::free_node(node_ptr);
 
-                    if(node_ptr == BSTree<T>::get_root()){
-                        BSTree<T>::get_root() = nullptr;
-                    }
+    /*!
+      \brief
+      function to get the number of values in the tree not greater than a value
 
-                    node_ptr= nullptr;
-                }
-                else{
-                }
-        }
+      \param value
+        upper bound, does not need to be in the tree
 
-        //havent found value yet
-        else if(value < node_ptr->data){
-            remove_node(node_ptr, node_ptr->left, visited_nodes, value);
-        }
+      \return
+      returns the number of values less than or equal to value
+    */
+    template<typename T>
+    unsigned AVLTree<T>::count_not_greater(const T& value) const{
+        unsigned result = 0;
+        const typename AVLTree<T>::BinTreeNode* node_ptr = BSTree<T>::root();
+        while(node_ptr != nullptr){
+            if(value < node_ptr->data){
+                node_ptr = node_ptr->left;
+            }
+            else{
 
-        //havent found value yet
-        else if(value > node_ptr->data){
-            remove_node(node_ptr, node_ptr->right, visited_nodes, value);
-        }
-        else {
+                //this node and its whole left subtree are not greater
+                result += (node_ptr->left ? node_ptr->left->count : 0) + 1;
+                node_ptr = node_ptr->right;
+            }
         }
+        return result;
     }
 
 
@@ -14,7 +14,7 @@
 #ifndef AVLTREE_H
 #define AVLTREE_H
 //---------------------------------------------------------------------------
-#include <stack>
+#include <algorithm> //std::max and std::min for the balance factors
 #include "BSTree.h"
 
 /*!
@@ -39,7 +39,9 @@ class AVLTree : public BSTree<T>
 
     /*!
       \brief
-      function to insert a node into AVLTree
+      function to insert a node into AVLTree. walks down without recursion,
+      keeping the path in an array on the stack, so nothing but the new node
+      is allocated
 
       \param value
         value to be inserted
@@ -51,7 +53,8 @@ class AVLTree : public BSTree<T>
 
     /*!
       \brief
-      function to remove a node
+      function to remove a node. walks down without recursion, keeping the path
+      in an array on the stack, so nothing is allocated
 
       \param value
       value to be removed from AVLTree
@@ -61,6 +64,47 @@ class AVLTree : public BSTree<T>
     */
      virtual void remove(const T& value) override;
 
+    /*!
+      \brief
+      function to find the node holding the k-th smallest value, going down
+      one path by the count of each left subtree
+
+      \param k
+        0 based position of the value in sorted order
+
+      \return
+      returns the node at position k, or nullptr if k is not less than size()
+    */
+     const typename AVLTree<T>::BinTreeNode* select(unsigned k) const;
+
+    /*!
+      \brief
+      function to get the number of values in the tree smaller than a value,
+      which is the position the value has or would have in sorted order
+
+      \param value
+        value to be ranked, does not need to be in the tree
+
+      \return
+      returns the number of values less than value
+    */
+     unsigned rank(const T& value) const;
+
+    /*!
+      \brief
+      function to count the values between two bounds without visiting them
+
+      \param lo
+        lowest value counted
+
+      \param hi
+        highest value counted
+
+      \return
+      returns the number of values v with lo <= v <= hi, 0 if hi < lo
+    */
+     unsigned count_range(const T& lo, const T& hi) const;
+
     //   // Returns true if efficiency implemented
     /*!
       \brief
@@ -74,59 +118,47 @@ class AVLTree : public BSTree<T>
   private:
     // private stuff...
 
+    //an AVL tree of n nodes is at most 1.44 * log2(n) high, so 64 levels of path
+    //hold far more nodes than count can
+    static const int MAX_PATH = 64;
+
     /*!
       \brief
-      function that is recursively called by insert()
-
-      \param parent
-      parent ndoe
+      function to get the number of values in the tree not greater than a value
 
-      \param node_ptr
-      child node
-
-      \param visited_nodes
-      reference to stack of visited nodes
-
-      \param number_of_recursions
-      number of times function is recursively called
+      \param value
+        upper bound, does not need to be in the tree
 
       \return
-      none
+      returns the number of values less than or equal to value
     */
-    void insert_node(typename AVLTree<T>::BinTreeNode*& parent, typename AVLTree<T>::BinTreeNode*& node_ptr,std::stack<typename AVLTree<T>::BinTreeNode**>& visited_nodes, T value, int& number_of_recursions);
+    unsigned count_not_greater(const T& value) const;
 
     /*!
       \brief
-      function to calculate balance factor of a node
+      function to get the balance factor of a node, kept up to date by insert,
+      remove and the rotations instead of being worked out from tree heights
 
       \param node_ptr
-        node to be calculated
+        node to be checked
 
       \return
-      returns balance factor of the node
+      returns height of left subtree - height of right subtree
     */
     int calculate_bf(typename AVLTree<T>::BinTreeNode* node_ptr);
 
     /*!
       \brief
-      function that is recursively called by remove()
-
-      \param parent
-      parent ndoe
+      function to rebalance a node whose balance factor is 2 or -2, with one
+      or two rotations
 
       \param node_ptr
-      child node
-
-      \param visited_nodes
-      reference to stack of visited nodes
-
-      \param number_of_recursions
-      number of times function is recursively called
+        node to be balanced, set to the new root of the subtree
 
       \return
       none
     */
-    void remove_node(typename AVLTree<T>::BinTreeNode*& parent, typename AVLTree<T>::BinTreeNode*& node_ptr,std::stack<typename AVLTree<T>::BinTreeNode**>& visited_nodes, T value);
+    void balance_node(typename AVLTree<T>::BinTreeNode*& node_ptr);
 
     /*!
       \brief
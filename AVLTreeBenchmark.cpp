@@ -0,0 +1,142 @@
+/*
+    AVLTree insert and remove throughput benchmark.
+
+    Inserts keys into an empty tree in three orders, then removes them again in a
+    random order, printing one JSON object per line:
+
+    {"pattern":"random","count":1000000,"operation":"insert","ns_per_op":...,
+     "ops_per_sec":...,"height":...,"size":...}
+
+    ascending   keys 0, 1, 2, ..., every insert rotates near the right edge
+    descending  keys count - 1 down to 0, the mirror image
+    random      the same keys shuffled, so rotations happen everywhere
+
+    After each insert run every key is removed in a shuffled order ("remove"), and
+    size has to be 0 again. Keys come from a fixed seed.
+
+    Build (with the BSTree and ObjectAllocator sources of the assignment):
+        g++ -std=c++17 -O2 AVLTreeBenchmark.cpp ObjectAllocator.cpp -o avltree_benchmark
+
+    Usage:
+        avltree_benchmark [--count 1000000] [--repeats 3] [--seed 1] [--out results.jsonl]
+
+    The fastest of the repeats is reported, each repeat starts from an empty tree.
+*/
+#include "AVLTree.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct RunResult {
+        double insert_ns;
+        double remove_ns;
+        int height;
+        unsigned size_after_insert;
+        unsigned size_after_remove;
+    };
+
+    RunResult run_once(const std::vector<int>& insert_keys, const std::vector<int>& remove_keys) {
+        RunResult result;
+        AVLTree<int> tree;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (int key : insert_keys) {
+            tree.insert(key);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        result.height = tree.height();
+        result.size_after_insert = tree.size();
+
+        auto remove_begin = std::chrono::steady_clock::now();
+        for (int key : remove_keys) {
+            tree.remove(key);
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.size_after_remove = tree.size();
+
+        result.insert_ns = std::chrono::duration<double, std::nano>(middle - begin).count();
+        result.remove_ns = std::chrono::duration<double, std::nano>(end - remove_begin).count();
+        return result;
+    }
+
+    void print_result(std::ostream& out, const char* pattern, unsigned count, const char* operation,
+                      double best_ns, int height, unsigned size) {
+        double ns_per_op = best_ns / count;
+        out << "{\"pattern\":\"" << pattern << "\",\"count\":" << count
+            << ",\"operation\":\"" << operation << "\""
+            << ",\"ns_per_op\":" << ns_per_op
+            << ",\"ops_per_sec\":" << (ns_per_op > 0 ? 1e9 / ns_per_op : 0.0)
+            << ",\"height\":" << height << ",\"size\":" << size << "}\n";
+    }
+
+    void run_pattern(std::ostream& out, const char* pattern, const std::vector<int>& insert_keys,
+                     const std::vector<int>& remove_keys, unsigned repeats) {
+        RunResult best = run_once(insert_keys, remove_keys);
+        for (unsigned i = 1; i < repeats; ++i) {
+            RunResult result = run_once(insert_keys, remove_keys);
+            best.insert_ns = std::min(best.insert_ns, result.insert_ns);
+            best.remove_ns = std::min(best.remove_ns, result.remove_ns);
+        }
+
+        const unsigned count = static_cast<unsigned>(insert_keys.size());
+        print_result(out, pattern, count, "insert", best.insert_ns, best.height, best.size_after_insert);
+        print_result(out, pattern, count, "remove", best.remove_ns, 0, best.size_after_remove);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    unsigned count = 1000000;
+    unsigned repeats = 3;
+    unsigned seed = 1;
+    std::string out_file;
+
+    if (!bench::parse_options(argc, argv, {
+            { "--count", bench::set_unsigned(count) },
+            { "--repeats", bench::set_unsigned(repeats) },
+            { "--seed", bench::set_unsigned(seed) },
+            { "--out", bench::set_string(out_file) } },
+            "[--count 1000000] [--repeats 3] [--seed 1] [--out file]")) {
+        return 1;
+    }
+    if (count == 0) {
+        count = 1;
+    }
+    if (repeats == 0) {
+        repeats = 1;
+    }
+
+    bench::Output output;
+    if (!output.open(out_file)) {
+        return 1;
+    }
+    std::ostream& out = output.stream();
+
+    std::mt19937 rng(seed);
+    auto shuffle = [&rng](std::vector<int>& keys) {
+        for (std::size_t i = keys.size(); i > 1; --i) {
+            std::swap(keys[i - 1], keys[bench::random_below(rng, static_cast<unsigned>(i))]);
+        }
+    };
+
+    std::vector<int> ascending(count);
+    for (unsigned i = 0; i < count; ++i) {
+        ascending[i] = static_cast<int>(i);
+    }
+    std::vector<int> descending(ascending.rbegin(), ascending.rend());
+    std::vector<int> random_order = ascending;
+    shuffle(random_order);
+    std::vector<int> remove_order = ascending;
+    shuffle(remove_order);
+
+    run_pattern(out, "ascending", ascending, remove_order, repeats);
+    run_pattern(out, "descending", descending, remove_order, repeats);
+    run_pattern(out, "random", random_order, remove_order, repeats);
+    return 0;
+}
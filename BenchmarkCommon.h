@@ -0,0 +1,153 @@
+/*
+    Pieces the benchmark programs share: "--name value" command line options, the
+    stream the JSON lines go to, the random numbers the inputs are built from and
+    the peak resident memory of the process.
+*/
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+namespace bench {
+
+    //one "--name value" option, set returns false if it cannot use the value
+    struct Option {
+        const char* name;
+        std::function<bool(const char* value)> set;
+    };
+
+    /*
+        hands every "--name value" pair to its option. An unknown name, a missing
+        value or a value the option rejects prints "usage: program arguments" and
+        returns false
+    */
+    inline bool parse_options(int argc, char* argv[], std::initializer_list<Option> options, const char* arguments) {
+        for (int i = 1; i < argc; ++i) {
+            const Option* match = nullptr;
+            for (const Option& option : options) {
+                if (!std::strcmp(argv[i], option.name)) {
+                    match = &option;
+                }
+            }
+            if (!match || i + 1 >= argc || !match->set(argv[++i])) {
+                std::cerr << "usage: " << argv[0] << ' ' << arguments << '\n';
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline std::function<bool(const char*)> set_unsigned(unsigned& value) {
+        return [&value](const char* text) {
+            char* end = nullptr;
+            unsigned long parsed = std::strtoul(text, &end, 10);
+            if (end == text || *end != '\0') {
+                return false;
+            }
+            value = static_cast<unsigned>(parsed);
+            return true;
+        };
+    }
+
+    inline std::function<bool(const char*)> set_string(std::string& value) {
+        return [&value](const char* text) {
+            value = text;
+            return true;
+        };
+    }
+
+    //non zero numbers separated by commas, "10000,100000"
+    inline std::function<bool(const char*)> set_unsigned_list(std::vector<unsigned>& values) {
+        return [&values](const char* text) {
+            values.clear();
+            while (*text) {
+                char* end = nullptr;
+                unsigned long value = std::strtoul(text, &end, 10);
+                if (end == text || value == 0 || (*end != ',' && *end != '\0')) {
+                    return false;
+                }
+                values.push_back(static_cast<unsigned>(value));
+                text = *end == ',' ? end + 1 : end;
+            }
+            return !values.empty();
+        };
+    }
+
+    //std::cout, or the file given with --out
+    class Output {
+    public:
+        //prints "cannot open" and returns false if the file cannot be created
+        bool open(const std::string& filename) {
+            if (filename.empty()) {
+                return true;
+            }
+            file.open(filename);
+            if (!file) {
+                std::cerr << "cannot open " << filename << '\n';
+                return false;
+            }
+            return true;
+        }
+
+        std::ostream& stream() {
+            if (file.is_open()) {
+                return file;
+            }
+            return std::cout;
+        }
+
+    private:
+        std::ofstream file;
+    };
+
+    /*
+        only the raw engine output is used, std distributions differ between
+        standard libraries and would change the inputs from one compiler to another
+    */
+    inline unsigned random_below(std::mt19937& rng, unsigned bound) {
+        return static_cast<unsigned>(rng() % bound);
+    }
+
+    inline unsigned long long peak_rss_kb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return 0;
+        }
+        return counters.PeakWorkingSetSize / 1024;
+#else
+        struct rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        //bytes on macOS, kilobytes everywhere else
+        return static_cast<unsigned long long>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<unsigned long long>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+}
@@ -0,0 +1,653 @@
+/*!*****************************************************************************
+\file ContractionHierarchy.cpp
+\author Lim Jian Rong (jianrong.lim@digipen.edu / 2201501@sit.singaporetech.edu.sg)
+\par Course: CSD2183 Section B
+\par Assignment: 4
+\date 19/03/2024
+\brief This file has definitions for functions for a ContractionHierarchy class.
+       It implements the node ordering (lazy updated edge difference), the
+       contraction of nodes with witness searches to decide which shortcuts are
+       needed, the packing of the hierarchy into upward and downward compressed
+       sparse rows, and the bidirectional upward query with path unpacking.
+*******************************************************************************/
+#include "ContractionHierarchy.h"
+#include <algorithm> //needed for the heap functions
+#include <functional> //needed for std::greater
+#include <queue> //used for the contraction order
+#include <utility> //used for std::pair
+
+
+const unsigned INFINITY_ = static_cast<unsigned>(-1);
+
+//a witness search gives up after settling this many nodes. giving up early only
+//means a shortcut is added that was not needed, the costs stay correct
+const unsigned WITNESS_SETTLE_LIMIT = 500;
+
+//graph that is left while nodes are contracted, out and in only hold edges
+//between nodes that are not contracted yet
+struct ContractionState
+{
+    std::vector<std::vector<ContractionEdge>> out;
+    std::vector<std::vector<ContractionEdge>> in;
+    std::vector<char> contracted;
+    std::vector<int> deleted_neighbours;
+
+    //witness search, dist is reset only where the last search touched it
+    std::vector<unsigned> dist;
+    std::vector<unsigned> touched;
+    std::vector<AdjacencyInfo> heap;
+};
+
+//struct used to keep track of a shortcut that contracting a node needs
+struct Shortcut
+{
+    unsigned from;
+    unsigned to;
+    unsigned weight;
+};
+
+    /*!
+      \brief
+      function to add an edge to a list, or lower the weight of the edge to the
+      same node if the list already has one
+
+      \param edges
+      list to add the edge to
+
+      \param id
+      node the edge goes to
+
+      \param weight
+      weight of the edge
+
+      \param middle
+      node the edge skips over, 0 for an original edge
+
+      \return
+      returns true if a new edge was added
+    */
+    static bool AddOrImproveEdge(std::vector<ContractionEdge>& edges, unsigned id, unsigned weight, unsigned middle) {
+        for(ContractionEdge& edge : edges){
+            if(edge.id == id){
+                if(weight < edge.weight){
+                    edge.weight = weight;
+                    edge.middle = middle;
+                }
+                return false;
+            }
+        }
+
+        ContractionEdge edge;
+        edge.id = id;
+        edge.weight = weight;
+        edge.middle = middle;
+        edges.push_back(edge);
+        return true;
+    }
+
+    /*!
+      \brief
+      function to remove the edge to a node from a list
+
+      \param edges
+      list to remove the edge from
+
+      \param id
+      node the edge goes to
+
+      \return
+      none
+    */
+    static void RemoveEdge(std::vector<ContractionEdge>& edges, unsigned id) {
+        for(unsigned int i=0; i < edges.size(); ++i){
+            if(edges[i].id == id){
+                edges[i] = edges.back();
+                edges.pop_back();
+                return;
+            }
+        }
+    }
+
+    /*!
+      \brief
+      function that runs a limited Dijkstra search on the graph that is left,
+      without going through the node that is being contracted
+
+      \param state
+      graph that is left, dist receives the costs found
+
+      \param source
+      node the search starts from
+
+      \param skipped
+      node being contracted, never visited
+
+      \param max_cost
+      the search stops once every node cheaper than this is settled
+
+      \return
+      none
+    */
+    static void WitnessSearch(ContractionState& state, unsigned source, unsigned skipped, unsigned max_cost) {
+        for(unsigned node : state.touched){
+            state.dist[node-1] = INFINITY_;
+        }
+        state.touched.clear();
+        state.heap.clear();
+
+        check_greater_than greater_than;
+        state.dist[source-1] = 0;
+        state.touched.push_back(source);
+        AdjacencyInfo info;
+        info.id = source;
+        info.weight = 0;
+        state.heap.push_back(info);
+
+        unsigned settled = 0;
+        while(!state.heap.empty() && settled < WITNESS_SETTLE_LIMIT){
+            std::pop_heap(state.heap.begin(), state.heap.end(), greater_than);
+            AdjacencyInfo top = state.heap.back();
+            state.heap.pop_back();
+            unsigned int u = top.id;
+            if(top.weight > state.dist[u-1]){
+                continue;
+            }
+            if(top.weight > max_cost){
+                break;
+            }
+            ++settled;
+
+            for(const ContractionEdge& edge : state.out[u-1]){
+                unsigned int v = edge.id;
+                if(v == skipped){
+                    continue;
+                }
+                unsigned int new_cost = state.dist[u-1] + edge.weight;
+                if(new_cost < state.dist[v-1]){
+                    if(state.dist[v-1] == INFINITY_){
+                        state.touched.push_back(v);
+                    }
+                    state.dist[v-1] = new_cost;
+                    AdjacencyInfo info2;
+                    info2.id = v;
+                    info2.weight = new_cost;
+                    state.heap.push_back(info2);
+                    std::push_heap(state.heap.begin(), state.heap.end(), greater_than);
+                }
+            }
+        }
+    }
+
+    /*!
+      \brief
+      function to find the shortcuts that contracting a node needs: one for every
+      in and out edge pair whose path through the node has no cheaper witness
+
+      \param state
+      graph that is left
+
+      \param node
+      node to contract
+
+      \param shortcuts
+      if not nullptr, receives the shortcuts
+
+      \return
+      returns the number of shortcuts needed
+    */
+    static unsigned FindShortcuts(ContractionState& state, unsigned node, std::vector<Shortcut>* shortcuts) {
+        unsigned count = 0;
+        const std::vector<ContractionEdge>& out = state.out[node-1];
+        if(out.empty()){
+            return 0;
+        }
+
+        for(const ContractionEdge& in_edge : state.in[node-1]){
+            unsigned int from = in_edge.id;
+
+            //one search from each in neighbour covers every out neighbour
+            unsigned int max_cost = 0;
+            for(const ContractionEdge& out_edge : out){
+                if(out_edge.id != from){
+                    max_cost = std::max(max_cost, in_edge.weight + out_edge.weight);
+                }
+            }
+            WitnessSearch(state, from, node, max_cost);
+
+            for(const ContractionEdge& out_edge : out){
+                if(out_edge.id == from){
+                    continue;
+                }
+                unsigned int through_node = in_edge.weight + out_edge.weight;
+                if(state.dist[out_edge.id-1] > through_node){
+                    ++count;
+                    if(shortcuts){
+                        Shortcut shortcut;
+                        shortcut.from = from;
+                        shortcut.to = out_edge.id;
+                        shortcut.weight = through_node;
+                        shortcuts->push_back(shortcut);
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    /*!
+      \brief
+      function to get how early a node should be contracted, lower goes first:
+      shortcuts added minus edges removed, plus the neighbours already contracted
+      so that contraction spreads evenly over the graph
+
+      \param state
+      graph that is left
+
+      \param node
+      node to get the priority of
+
+      \return
+      returns the priority of the node
+    */
+    static int ContractionPriority(ContractionState& state, unsigned node) {
+        int shortcuts = static_cast<int>(FindShortcuts(state, node, nullptr));
+        int removed = static_cast<int>(state.in[node-1].size() + state.out[node-1].size());
+        return shortcuts - removed + state.deleted_neighbours[node-1];
+    }
+
+    /*!
+      \brief
+      function to pack per node edge lists into compressed sparse row form
+
+      \param lists
+      edge list of every node
+
+      \param offsets
+      receives the offsets, edges of node n start at offsets[n-1]
+
+      \param edges
+      receives every edge
+
+      \return
+      none
+    */
+    static void PackEdges(std::vector<std::vector<ContractionEdge>>& lists,
+                          std::vector<unsigned>& offsets, std::vector<ContractionEdge>& edges) {
+        offsets.assign(lists.size() + 1, 0);
+        for(unsigned int i=0; i < lists.size(); ++i){
+            offsets[i+1] = offsets[i] + static_cast<unsigned>(lists[i].size());
+        }
+        edges.clear();
+        edges.reserve(offsets.back());
+        for(std::vector<ContractionEdge>& list : lists){
+            edges.insert(edges.end(), list.begin(), list.end());
+            std::vector<ContractionEdge>().swap(list);
+        }
+    }
+
+    /*!
+      \brief
+      constructor for ContractionHierarchy, orders and contracts every node of
+      the graph. the graph is only read, later changes to it are not seen
+
+      \param graph
+      graph to build the hierarchy of
+
+      \return
+      none
+    */
+    ContractionHierarchy::ContractionHierarchy(const ALGraph& graph) {
+        ALIST aList = graph.GetAList();
+        total_num_of_nodes = static_cast<unsigned>(aList.size());
+        shortcut_count = 0;
+        rank.assign(total_num_of_nodes, 0);
+
+        ContractionState state;
+        state.out.resize(total_num_of_nodes);
+        state.in.resize(total_num_of_nodes);
+        state.contracted.assign(total_num_of_nodes, 0);
+        state.deleted_neighbours.assign(total_num_of_nodes, 0);
+        state.dist.assign(total_num_of_nodes, INFINITY_);
+
+        //parallel edges collapse into the cheapest one, loops never help a path
+        for(unsigned int i=0; i < total_num_of_nodes; ++i){
+            for(const AdjacencyInfo& info : aList[i]){
+                if(info.id == i+1){
+                    continue;
+                }
+                AddOrImproveEdge(state.out[i], info.id, info.weight, 0);
+                AddOrImproveEdge(state.in[info.id-1], i+1, info.weight, 0);
+            }
+        }
+        ALIST().swap(aList);
+
+        std::priority_queue<std::pair<int, unsigned>, std::vector<std::pair<int, unsigned>>,
+                            std::greater<std::pair<int, unsigned>>> order;
+        for(unsigned int node = 1; node <= total_num_of_nodes; ++node){
+            order.push(std::make_pair(ContractionPriority(state, node), node));
+        }
+
+        std::vector<std::vector<ContractionEdge>> up_lists(total_num_of_nodes);
+        std::vector<std::vector<ContractionEdge>> down_lists(total_num_of_nodes);
+        std::vector<Shortcut> shortcuts;
+        unsigned next_rank = 0;
+
+        while(!order.empty()){
+            unsigned int node = order.top().second;
+            order.pop();
+            if(state.contracted[node-1]){
+                continue;
+            }
+
+            //priorities go stale as neighbours get contracted, so recheck before
+            //contracting and put the node back if it is no longer the cheapest
+            int priority = ContractionPriority(state, node);
+            if(!order.empty() && priority > order.top().first){
+                order.push(std::make_pair(priority, node));
+                continue;
+            }
+
+            rank[node-1] = next_rank++;
+            shortcuts.clear();
+            FindShortcuts(state, node, &shortcuts);
+
+            //every edge still attached leads to a node contracted later, which is
+            //exactly the upward edges of this node
+            up_lists[node-1] = state.out[node-1];
+            down_lists[node-1] = state.in[node-1];
+
+            for(const ContractionEdge& edge : state.out[node-1]){
+                RemoveEdge(state.in[edge.id-1], node);
+                ++state.deleted_neighbours[edge.id-1];
+            }
+            for(const ContractionEdge& edge : state.in[node-1]){
+                RemoveEdge(state.out[edge.id-1], node);
+                ++state.deleted_neighbours[edge.id-1];
+            }
+            std::vector<ContractionEdge>().swap(state.out[node-1]);
+            std::vector<ContractionEdge>().swap(state.in[node-1]);
+            state.contracted[node-1] = 1;
+
+            for(const Shortcut& shortcut : shortcuts){
+                if(AddOrImproveEdge(state.out[shortcut.from-1], shortcut.to, shortcut.weight, node)){
+                    ++shortcut_count;
+                }
+                AddOrImproveEdge(state.in[shortcut.to-1], shortcut.from, shortcut.weight, node);
+            }
+        }
+
+        PackEdges(up_lists, up_offsets, up_edges);
+        PackEdges(down_lists, down_offsets, down_edges);
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ContractionHierarchy::ShortestPath(unsigned source, unsigned target) const {
+        ContractionWorkspace workspace;
+        return ShortestPath(source, target, workspace);
+    }
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes, using a workspace
+      owned by the caller so many threads can query one hierarchy
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param workspace
+      holds the search state, reuse it between queries
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ContractionHierarchy::ShortestPath(unsigned source, unsigned target, ContractionWorkspace& workspace) const {
+        std::vector<unsigned>& forward_dist = workspace.forward_dist;
+        std::vector<unsigned>& backward_dist = workspace.backward_dist;
+        std::vector<unsigned>& forward_previous = workspace.forward_previous;
+        std::vector<unsigned>& backward_previous = workspace.backward_previous;
+
+        //full reset only the first time, after that only what the last query touched
+        if(forward_dist.size() != total_num_of_nodes){
+            forward_dist.assign(total_num_of_nodes, INFINITY_);
+            backward_dist.assign(total_num_of_nodes, INFINITY_);
+            forward_previous.assign(total_num_of_nodes, 0);
+            backward_previous.assign(total_num_of_nodes, 0);
+            workspace.touched.clear();
+        }
+        for(unsigned node : workspace.touched){
+            forward_dist[node-1] = INFINITY_;
+            backward_dist[node-1] = INFINITY_;
+            forward_previous[node-1] = 0;
+            backward_previous[node-1] = 0;
+        }
+        workspace.touched.clear();
+        workspace.forward_heap.clear();
+        workspace.backward_heap.clear();
+
+        check_greater_than greater_than;
+        AdjacencyInfo info;
+        info.weight = 0;
+        info.id = source;
+        forward_dist[source-1] = 0;
+        workspace.forward_heap.push_back(info);
+        info.id = target;
+        backward_dist[target-1] = 0;
+        workspace.backward_heap.push_back(info);
+        workspace.touched.push_back(source);
+        workspace.touched.push_back(target);
+
+        unsigned long long best_cost = INFINITY_;
+        unsigned meeting_node = 0;
+
+        for(;;){
+            //a side is done once nothing left on it can beat the best path
+            bool forward_open = !workspace.forward_heap.empty() && workspace.forward_heap.front().weight < best_cost;
+            bool backward_open = !workspace.backward_heap.empty() && workspace.backward_heap.front().weight < best_cost;
+            if(!forward_open && !backward_open){
+                break;
+            }
+            bool forward_turn = forward_open &&
+                (!backward_open || workspace.forward_heap.front().weight <= workspace.backward_heap.front().weight);
+
+            std::vector<AdjacencyInfo>& heap = forward_turn ? workspace.forward_heap : workspace.backward_heap;
+            std::vector<unsigned>& dist = forward_turn ? forward_dist : backward_dist;
+            std::vector<unsigned>& previous = forward_turn ? forward_previous : backward_previous;
+            const std::vector<unsigned>& other_dist = forward_turn ? backward_dist : forward_dist;
+            const std::vector<unsigned>& offsets = forward_turn ? up_offsets : down_offsets;
+            const std::vector<ContractionEdge>& edges = forward_turn ? up_edges : down_edges;
+
+            std::pop_heap(heap.begin(), heap.end(), greater_than);
+            AdjacencyInfo top = heap.back();
+            heap.pop_back();
+            unsigned int u = top.id;
+            if(top.weight > dist[u-1]){
+                continue;
+            }
+
+            if(other_dist[u-1] != INFINITY_ && static_cast<unsigned long long>(dist[u-1]) + other_dist[u-1] < best_cost){
+                best_cost = static_cast<unsigned long long>(dist[u-1]) + other_dist[u-1];
+                meeting_node = u;
+            }
+
+            //stall on demand: if a more important node already reaches u cheaper by
+            //coming down to it, this upward cost is not a shortest one, do not spread it
+            const std::vector<unsigned>& opposite_offsets = forward_turn ? down_offsets : up_offsets;
+            const std::vector<ContractionEdge>& opposite_edges = forward_turn ? down_edges : up_edges;
+            bool stalled = false;
+            for(unsigned int e = opposite_offsets[u-1]; e < opposite_offsets[u] && !stalled; ++e){
+                unsigned int higher = opposite_edges[e].id;
+                stalled = dist[higher-1] != INFINITY_ && dist[higher-1] + opposite_edges[e].weight < dist[u-1];
+            }
+            if(stalled){
+                continue;
+            }
+
+            for(unsigned int e = offsets[u-1]; e < offsets[u]; ++e){
+                unsigned int v = edges[e].id;
+                unsigned int new_cost = dist[u-1] + edges[e].weight;
+                if(new_cost < dist[v-1]){
+                    if(forward_dist[v-1] == INFINITY_ && backward_dist[v-1] == INFINITY_){
+                        workspace.touched.push_back(v);
+                    }
+                    dist[v-1] = new_cost;
+                    previous[v-1] = u;
+                    AdjacencyInfo info2;
+                    info2.id = v;
+                    info2.weight = new_cost;
+                    heap.push_back(info2);
+                    std::push_heap(heap.begin(), heap.end(), greater_than);
+
+                    if(other_dist[v-1] != INFINITY_ && static_cast<unsigned long long>(new_cost) + other_dist[v-1] < best_cost){
+                        best_cost = static_cast<unsigned long long>(new_cost) + other_dist[v-1];
+                        meeting_node = v;
+                    }
+                }
+            }
+        }
+
+        DijkstraInfo result;
+        result.cost = INFINITY_;
+        if(meeting_node == 0){
+            return result;
+        }
+        result.cost = static_cast<unsigned>(best_cost);
+
+        //nodes of the hierarchy path from source up to the meeting node
+        std::vector<unsigned> up_path;
+        for(unsigned int curr_node = meeting_node; curr_node != 0; curr_node = forward_previous[curr_node-1]){
+            up_path.push_back(curr_node);
+        }
+        std::reverse(up_path.begin(), up_path.end());
+
+        result.path.push_back(source);
+        for(unsigned int i=1; i < up_path.size(); ++i){
+            UnpackEdge(up_path[i-1], up_path[i], result.path);
+        }
+
+        //down to target, the previous node of the backward search is the next one towards target
+        for(unsigned int curr_node = meeting_node; backward_previous[curr_node-1] != 0; curr_node = backward_previous[curr_node-1]){
+            UnpackEdge(curr_node, backward_previous[curr_node-1], result.path);
+        }
+        return result;
+    }
+
+    /*!
+      \brief
+      function to get the number of nodes in the hierarchy
+
+      \return
+      returns the number of nodes of the graph it was built from
+    */
+    unsigned ContractionHierarchy::GetNodeCount() const {
+        return total_num_of_nodes;
+    }
+
+    /*!
+      \brief
+      function to get the number of shortcut edges that were added
+
+      \return
+      returns the number of shortcuts
+    */
+    unsigned ContractionHierarchy::GetShortcutCount() const {
+        return shortcut_count;
+    }
+
+    /*!
+      \brief
+      function to get the position of a node in the contraction order
+
+      \param node
+      node to get the rank of
+
+      \return
+      returns 0 for the node contracted first up to node count - 1
+    */
+    unsigned ContractionHierarchy::GetRank(unsigned node) const {
+        return rank[node-1];
+    }
+
+    /*!
+      \brief
+      function to get the node a shortcut skips over, for an edge of the hierarchy
+
+      \param from
+      node the edge starts from
+
+      \param to
+      node the edge ends at
+
+      \return
+      returns the middle node of the edge, 0 for an original edge
+    */
+    unsigned ContractionHierarchy::GetMiddle(unsigned from, unsigned to) const {
+        //an edge is kept by whichever end was contracted first
+        if(rank[from-1] < rank[to-1]){
+            for(unsigned int e = up_offsets[from-1]; e < up_offsets[from]; ++e){
+                if(up_edges[e].id == to){
+                    return up_edges[e].middle;
+                }
+            }
+        }
+        else{
+            for(unsigned int e = down_offsets[to-1]; e < down_offsets[to]; ++e){
+                if(down_edges[e].id == from){
+                    return down_edges[e].middle;
+                }
+            }
+        }
+        return 0;
+    }
+
+    /*!
+      \brief
+      function to replace a shortcut edge by the original edges it stands for
+
+      \param from
+      node the edge starts from, already on the path
+
+      \param to
+      node the edge ends at
+
+      \param path
+      receives every node after from, up to and including to
+
+      \return
+      none
+    */
+    void ContractionHierarchy::UnpackEdge(unsigned from, unsigned to, std::vector<unsigned>& path) const {
+        //shortcuts can nest deeply, so unpack with a stack instead of recursion
+        std::vector<std::pair<unsigned, unsigned>> pending;
+        pending.push_back(std::make_pair(from, to));
+        while(!pending.empty()){
+            std::pair<unsigned, unsigned> edge = pending.back();
+            pending.pop_back();
+
+            unsigned int middle = GetMiddle(edge.first, edge.second);
+            if(middle == 0){
+                path.push_back(edge.second);
+                continue;
+            }
+
+            //first half goes on top so it is unpacked first
+            pending.push_back(std::make_pair(middle, edge.second));
+            pending.push_back(std::make_pair(edge.first, middle));
+        }
+    }
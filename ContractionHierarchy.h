@@ -0,0 +1,176 @@
+/*!*****************************************************************************
+\file ContractionHierarchy.h
+\author Lim Jian Rong (jianrong.lim@digipen.edu / 2201501@sit.singaporetech.edu.sg)
+\par Course: CSD2183 Section B
+\par Assignment: 4
+\date 19/03/2024
+\brief This file has declarations for a ContractionHierarchy class, built once
+       from an ALGraph that no longer changes. Nodes are contracted one by one
+       from least to most important, adding shortcut edges so that shortest path
+       costs are kept, and every edge is stored going up the order. A point to
+       point query is then a small bidirectional search that only ever moves to
+       more important nodes, and shortcuts are unpacked back into the original
+       node ids so paths look the same as the paths of ALGraph::Dijkstra.
+*******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+//---------------------------------------------------------------------------
+#include "ALGraph.h"
+#include <vector> //used for the edge arrays
+
+//struct used to keep track of one edge of the hierarchy, middle is the node a
+//shortcut skips over, 0 for an edge of the original graph
+struct ContractionEdge
+{
+  unsigned id;
+  unsigned weight;
+  unsigned middle;
+};
+
+//struct used to hold the state of one query, owned by the caller so queries on
+//the same hierarchy do not share anything. the cost arrays are only reset where
+//the last query touched them, so a reused workspace makes queries cost only the
+//nodes they visit
+struct ContractionWorkspace
+{
+  std::vector<unsigned> forward_dist;
+  std::vector<unsigned> backward_dist;
+  std::vector<unsigned> forward_previous;
+  std::vector<unsigned> backward_previous;
+  std::vector<AdjacencyInfo> forward_heap;
+  std::vector<AdjacencyInfo> backward_heap;
+  std::vector<unsigned> touched;
+};
+
+class ContractionHierarchy
+{
+  public:
+
+    /*!
+      \brief
+      constructor for ContractionHierarchy, orders and contracts every node of
+      the graph. the graph is only read, later changes to it are not seen
+
+      \param graph
+      graph to build the hierarchy of
+
+      \return
+      none
+    */
+    ContractionHierarchy(const ALGraph& graph);
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ShortestPath(unsigned source, unsigned target) const;
+
+    /*!
+      \brief
+      function to find the shortest path between two nodes, using a workspace
+      owned by the caller so many threads can query one hierarchy
+
+      \param source
+      node the path starts from
+
+      \param target
+      node the path ends at
+
+      \param workspace
+      holds the search state, reuse it between queries
+
+      \return
+      returns the cost and nodes of the path, cost is static_cast<unsigned>(-1)
+      and the path is empty if target cannot be reached
+    */
+    DijkstraInfo ShortestPath(unsigned source, unsigned target, ContractionWorkspace& workspace) const;
+
+    /*!
+      \brief
+      function to get the number of nodes in the hierarchy
+
+      \return
+      returns the number of nodes of the graph it was built from
+    */
+    unsigned GetNodeCount(void) const;
+
+    /*!
+      \brief
+      function to get the number of shortcut edges that were added
+
+      \return
+      returns the number of shortcuts
+    */
+    unsigned GetShortcutCount(void) const;
+
+    /*!
+      \brief
+      function to get the position of a node in the contraction order
+
+      \param node
+      node to get the rank of
+
+      \return
+      returns 0 for the node contracted first up to node count - 1
+    */
+    unsigned GetRank(unsigned node) const;
+
+  private:
+    /*!
+      \brief
+      function to get the node a shortcut skips over, for an edge of the hierarchy
+
+      \param from
+      node the edge starts from
+
+      \param to
+      node the edge ends at
+
+      \return
+      returns the middle node of the edge, 0 for an original edge
+    */
+    unsigned GetMiddle(unsigned from, unsigned to) const;
+
+    /*!
+      \brief
+      function to replace a shortcut edge by the original edges it stands for
+
+      \param from
+      node the edge starts from, already on the path
+
+      \param to
+      node the edge ends at
+
+      \param path
+      receives every node after from, up to and including to
+
+      \return
+      none
+    */
+    void UnpackEdge(unsigned from, unsigned to, std::vector<unsigned>& path) const;
+
+    unsigned total_num_of_nodes;
+    unsigned shortcut_count;
+    std::vector<unsigned> rank;
+
+    //edges to more important nodes, up_edges[up_offsets[n-1]] up to up_edges[up_offsets[n]]
+    std::vector<unsigned> up_offsets;
+    std::vector<ContractionEdge> up_edges;
+
+    //edges coming from more important nodes, stored at the node they end at and
+    //pointing back at the node they come from, for the search from the target
+    std::vector<unsigned> down_offsets;
+    std::vector<ContractionEdge> down_edges;
+};
+#endif
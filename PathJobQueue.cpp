@@ -0,0 +1,216 @@
+#include <pch.h>
+#include "PathJobQueue.h"
+#include <algorithm>
+
+
+PathJobQueue::PathJobQueue(AStarPather& pather) : pather(pather),
+    next_job_id(1), next_order(0), running_job_id(0), running_owner(0),
+    running_cancelled(false), running_stale(false), map_changing(false), stopping(false) {
+}
+
+PathJobQueue::~PathJobQueue() {
+    shutdown();
+}
+
+bool PathJobQueue::initialize() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (worker.joinable()) {
+        return true;
+    }
+    stopping = false;
+    worker = std::thread(&PathJobQueue::worker_loop, this);
+    return true;
+}
+
+void PathJobQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+        queued_jobs.clear();
+        completed_jobs.clear();
+    }
+    work_available.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+unsigned PathJobQueue::submit(const PathRequest& request, int priority, unsigned owner, PathJobCallback callback) {
+    Job job;
+    job.request = request;
+    job.priority = priority;
+    job.owner = owner;
+    job.callback = std::move(callback);
+    job.result = PathResult::PROCESSING;
+
+    //the worker cannot single step or color the terrain
+    job.request.newRequest = true;
+    job.request.settings.singleStep = false;
+    job.request.settings.debugColoring = false;
+    job.request.path.clear();
+
+    unsigned job_id{};
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (next_job_id == 0) {
+            ++next_job_id;
+        }
+        job_id = next_job_id++;
+        job.id = job_id;
+        job.order = next_order++;
+
+        //newer request from the same owner supersedes the old one
+        if (owner != 0) {
+            remove_queued(0, owner);
+        }
+
+        queued_jobs.push_back(std::move(job));
+        std::push_heap(queued_jobs.begin(), queued_jobs.end(), job_after());
+    }
+    work_available.notify_one();
+
+    return job_id;
+}
+
+bool PathJobQueue::cancel(unsigned job_id) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return remove_queued(job_id, 0);
+}
+
+void PathJobQueue::cancel_owner(unsigned owner) {
+    if (owner == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    remove_queued(0, owner);
+}
+
+/*
+    removes the job with job_id, or every job of owner if job_id is 0, from the
+    queued and completed lists, and flags the running job if it matches.
+    queue_mutex must be held
+*/
+bool PathJobQueue::remove_queued(unsigned job_id, unsigned owner) {
+    auto matches = [job_id, owner](const Job& job) {
+        return job_id != 0 ? job.id == job_id : job.owner == owner;
+    };
+    bool removed = false;
+
+    auto queued_end = std::remove_if(queued_jobs.begin(), queued_jobs.end(), matches);
+    if (queued_end != queued_jobs.end()) {
+        queued_jobs.erase(queued_end, queued_jobs.end());
+        std::make_heap(queued_jobs.begin(), queued_jobs.end(), job_after());
+        removed = true;
+    }
+
+    auto completed_end = std::remove_if(completed_jobs.begin(), completed_jobs.end(), matches);
+    if (completed_end != completed_jobs.end()) {
+        completed_jobs.erase(completed_end, completed_jobs.end());
+        removed = true;
+    }
+
+    if (running_job_id != 0 && (job_id != 0 ? running_job_id == job_id : running_owner == owner)) {
+        running_cancelled = true;
+        removed = true;
+    }
+    return removed;
+}
+
+void PathJobQueue::dispatch_completed(int max_callbacks) {
+    std::vector<Job> finished;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (max_callbacks <= 0 || max_callbacks >= static_cast<int>(completed_jobs.size())) {
+            finished.swap(completed_jobs);
+        }
+        else {
+            finished.assign(std::make_move_iterator(completed_jobs.begin()),
+                std::make_move_iterator(completed_jobs.begin() + max_callbacks));
+            completed_jobs.erase(completed_jobs.begin(), completed_jobs.begin() + max_callbacks);
+        }
+    }
+
+    //callbacks run without the lock so they are free to submit new jobs
+    for (Job& job : finished) {
+        if (job.callback) {
+            job.callback(job.id, job.result, job.request);
+        }
+    }
+}
+
+int PathJobQueue::pending_count() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return static_cast<int>(queued_jobs.size()) + (running_job_id != 0 ? 1 : 0);
+}
+
+/*
+    stops the running search at its next expansion and waits for the worker to let
+    go of the terrain. the job is marked stale so the worker queues it again
+*/
+void PathJobQueue::begin_map_change() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    map_changing = true;
+    if (running_job_id == 0) {
+        return;
+    }
+
+    running_stale = true;
+    pather.set_search_abort(true);
+    worker_idle.wait(lock, [this] { return running_job_id == 0; });
+    pather.set_search_abort(false);
+}
+
+void PathJobQueue::end_map_change() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        map_changing = false;
+    }
+    work_available.notify_one();
+}
+
+void PathJobQueue::worker_loop() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+
+    for (;;) {
+        work_available.wait(lock, [this] { return stopping || (!map_changing && !queued_jobs.empty()); });
+        if (stopping) {
+            return;
+        }
+
+        std::pop_heap(queued_jobs.begin(), queued_jobs.end(), job_after());
+        Job job = std::move(queued_jobs.back());
+        queued_jobs.pop_back();
+
+        running_job_id = job.id;
+        running_owner = job.owner;
+        running_cancelled = false;
+        running_stale = false;
+        lock.unlock();
+
+        //the version still catches a MAP_CHANGE sent without begin_map_change
+        unsigned map_version = pather.get_map_version();
+        job.result = pather.compute_path(job.request);
+        bool map_changed = map_version != pather.get_map_version();
+
+        lock.lock();
+        running_job_id = 0;
+        running_owner = 0;
+        worker_idle.notify_all();
+
+        if (running_cancelled || stopping) {
+            continue;
+        }
+
+        //map changed under the search, run it again on the new map
+        if (running_stale || map_changed) {
+            job.request.newRequest = true;
+            job.request.path.clear();
+            queued_jobs.push_back(std::move(job));
+            std::push_heap(queued_jobs.begin(), queued_jobs.end(), job_after());
+            continue;
+        }
+
+        completed_jobs.push_back(std::move(job));
+    }
+}
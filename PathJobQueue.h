@@ -0,0 +1,114 @@
+#pragma once
+#include "P2_Pathfinding.h"
+#include <vector>
+#include <thread>
+#include <condition_variable>
+
+/*
+    Called on the thread that calls PathJobQueue::dispatch_completed, never on the
+    worker, so it is safe to touch agents and the terrain from inside it.
+*/
+using PathJobCallback = std::function<void(unsigned job_id, PathResult result, PathRequest& request)>;
+
+/*
+    Background servicing of path requests.
+
+    Jobs are taken highest priority first (oldest first within a priority) by one
+    worker thread, one worker because the search state of AStarPather is global.
+    Finished jobs wait until dispatch_completed is called from the game update,
+    which runs their callbacks, the same way MAP_CHANGE listeners are run.
+
+    Jobs submitted with the same non-zero owner supersede each other: a new
+    submission cancels whatever that owner still has queued or running, so an
+    agent that re-plans every frame only ever gets its newest path back.
+
+    Queued requests always run as a fresh, non single step search without debug
+    coloring. Do not single step a request through compute_path while the queue
+    has work, both would be using the same node map. A compute_path call on the
+    game thread waits for the job the worker is running.
+
+    The worker reads the terrain, so the game thread has to call begin_map_change
+    before it edits the walls and end_map_change once MAP_CHANGE has been sent.
+    begin_map_change stops the running search at its next expansion and queues
+    that job again, and no job starts until end_map_change.
+*/
+class PathJobQueue
+{
+public:
+    PathJobQueue(AStarPather& pather);
+    ~PathJobQueue();
+
+    bool initialize();
+    void shutdown();
+
+    /*
+        Queues a copy of request, returns the id of the job (never 0).
+        Larger priority values are serviced first.
+    */
+    unsigned submit(const PathRequest& request, int priority, unsigned owner, PathJobCallback callback);
+
+    /*
+        Drops a job that is queued, running or finished but not yet dispatched,
+        its callback will not be called. Returns false if the job is unknown or
+        was already dispatched.
+    */
+    bool cancel(unsigned job_id);
+    void cancel_owner(unsigned owner);
+
+    /*
+        Runs the callbacks of jobs finished since the last call, on the calling
+        thread. max_callbacks limits how many are run this call, 0 means all.
+    */
+    void dispatch_completed(int max_callbacks = 0);
+
+    int pending_count() const;
+
+    /*
+        Bracket every edit of the terrain, see the class comment. begin_map_change
+        returns once the worker has stopped touching the terrain.
+    */
+    void begin_map_change();
+    void end_map_change();
+
+private:
+    struct Job {
+        unsigned id;
+        unsigned owner;
+        int priority;
+        unsigned long long order;
+        PathRequest request;
+        PathResult result;
+        PathJobCallback callback;
+    };
+
+    //heap comparator, top of the heap is the highest priority, oldest job
+    struct job_after {
+        bool operator()(const Job& lhs, const Job& rhs) const {
+            if (lhs.priority != rhs.priority) {
+                return lhs.priority < rhs.priority;
+            }
+            return lhs.order > rhs.order;
+        }
+    };
+
+    void worker_loop();
+    bool remove_queued(unsigned job_id, unsigned owner);
+
+    AStarPather& pather;
+    std::thread worker;
+
+    mutable std::mutex queue_mutex;
+    std::condition_variable work_available;
+    std::condition_variable worker_idle;
+    std::vector<Job> queued_jobs;
+    std::vector<Job> completed_jobs;
+
+    unsigned next_job_id;
+    unsigned long long next_order;
+    unsigned running_job_id;
+    unsigned running_owner;
+    bool running_cancelled;
+    bool running_stale;
+    bool map_changing;
+    bool stopping;
+};
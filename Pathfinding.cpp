@@ -1,15 +1,38 @@
+#ifdef PATHFINDING_HEADLESS
+#include "PathfindingHeadless.h"
+#include "Pathfinding.h"
+#else
 #include <pch.h>
 #include "Projects/ProjectTwo.h"
 #include "P2_Pathfinding.h"
+#endif
+#include <algorithm>
 #include <list>
 #include <iterator>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include "MappedFile.h"
+
+//counters compile away entirely when PATHFINDING_NO_STATS is defined
+#ifndef PATHFINDING_NO_STATS
+#define PATH_STAT(statement) statement
+#else
+#define PATH_STAT(statement)
+#endif
+
+using stats_clock = std::chrono::steady_clock;
+
+inline double elapsed_ms(stats_clock::time_point begin, stats_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
 
 
 const int num_portions = 30;
 int active_portions[num_portions];
 
 const int portion_size = open_list_size / num_portions;
-const float inv_portion_size = 1.f / portion_size;
 
 //int last_active_index = 0;
 using xy = char[2];
@@ -20,13 +43,77 @@ mini_arr open_list_arr[open_list_size];
 
 float slices_per_interval{ 4.f };
 
+//fixed point costs, 1 cell = 1024, diagonal = sqrt(2) * 1024 rounded,
+//a bucket is 256 so there are the same 4 buckets per cell as slices_per_interval
+const int fixed_cost_shift = 10;
+const int fixed_cost_scale = 1 << fixed_cost_shift;
+const int fixed_diagonal_cost = 1448;
+const int fixed_bucket_shift = 8;
+
 int index_of_cheapest_bucket = -1;
 int largest = 0;
 
-float rfw_distances[40 * 40][40 * 40];
-int rfw_closest_node_index[40 * 40][40 * 40];
+//debug trace ring buffer, trace_count only ever grows, the slot is trace_count & trace_mask
+const unsigned trace_capacity = 1u << 16;
+const unsigned trace_mask = trace_capacity - 1;
+TraceRecord trace_records[trace_capacity];
+unsigned long long trace_count = 0;
+unsigned long long trace_replayed = 0;
+unsigned trace_step = 0;
+
+inline void record_trace(const GridPos& pos, TraceEvent event) {
+    TraceRecord& record = trace_records[trace_count++ & trace_mask];
+    record.cell = static_cast<unsigned short>(pos.row * terrain->get_map_width() + pos.col);
+    record.event = event;
+    record.step = trace_step;
+}
+
+float rfw_distances_storage[40 * 40][40 * 40];
+int rfw_closest_node_index_storage[40 * 40][40 * 40];
+
+//point at the storage above, or at the rows of a mapped precompute cache file.
+//the mapping is read only, so the tables are only written while they point at storage
+float (*rfw_distances)[40 * 40] = rfw_distances_storage;
+int (*rfw_closest_node_index)[40 * 40] = rfw_closest_node_index_storage;
 #define root2 1.41f
 
+/*
+    Precompute cache file, all sections start on a 64 byte boundary:
+        header
+        walls       1 byte per cell, row * width + col
+        neighbours  1 byte per cell, the neighbour bitmask
+        distances   one row of 40 * 40 floats per cell
+        closest     one row of 40 * 40 ints per cell
+    The rows keep the in memory stride so the tables can point straight into the mapping.
+    Bump precompute_cache_version whenever the layout or either precompute changes.
+*/
+const char precompute_cache_magic[8] = { 'A','S','T','A','R','P','C','F' };
+const unsigned precompute_cache_version = 1;
+const unsigned long long precompute_cache_alignment = 64;
+
+struct PrecomputeCacheHeader {
+    char magic[8];
+    unsigned version;
+    unsigned cell_count;
+    unsigned long long terrain_hash;
+    int map_width;
+    int map_height;
+    unsigned long long walls_offset;
+    unsigned long long neighbours_offset;
+    unsigned long long distances_offset;
+    unsigned long long closest_offset;
+    unsigned long long file_size;
+};
+
+MappedFile precompute_cache_file;
+
+void release_precompute_cache() {
+    rfw_distances = rfw_distances_storage;
+    rfw_closest_node_index = rfw_closest_node_index_storage;
+    precompute_cache_file.close();
+}
+
+#ifndef PATHFINDING_HEADLESS
 #pragma region Extra Credit
 bool ProjectTwo::implemented_floyd_warshall()
 {
@@ -43,6 +130,7 @@ bool ProjectTwo::implemented_jps_plus()
     return false;
 }
 #pragma endregion
+#endif
 
 
 int gridpos_to_index(int row, int col) {
@@ -56,6 +144,8 @@ GridPos index_to_gridpos(int index) {
 
 }
 void AStarPather::precompute_roy_floyd() {
+    //a loaded cache file is mapped read only, go back to the storage before writing
+    release_precompute_cache();
 
     for (int i = 0; i < terrain->get_map_height() * terrain->get_map_width(); ++i) {
         for (int u = 0; u < terrain->get_map_height() * terrain->get_map_width(); ++u) {
@@ -87,6 +177,10 @@ void AStarPather::precompute_roy_floyd() {
             int idx = gridpos_to_index(i, u);
             for (int y = -1; y <= 1; ++y) {
                 for (int x = -1; x <= 1; ++x) {
+                    //cell to itself stays at 0, do not overwrite it with a diagonal cost
+                    if (x == 0 && y == 0) {
+                        continue;
+                    }
                     int neighbor_row = i + y;
                     int neighbor_col = u + x;
                     int neighbour_index = gridpos_to_index(neighbor_row, neighbor_col);
@@ -142,6 +236,213 @@ void AStarPather::precompute_roy_floyd() {
 
 }
 
+void AStarPather::query_distances(const GridPos& start, const GridPos* goals, int goal_count,
+    float* distances, GridPos* first_steps) const {
+
+    std::lock_guard<std::mutex> lock(search_mutex);
+    const int map_width = terrain->get_map_width();
+    const int start_1d_index = gridpos_to_index(start.row, start.col);
+
+    //every distance from start lives in one row of the table, so the whole
+    //target list is a straight gather out of that row
+    const float* distances_from_start = rfw_distances[start_1d_index];
+    for (int i = 0; i < goal_count; ++i) {
+        distances[i] = distances_from_start[goals[i].row * map_width + goals[i].col];
+    }
+
+    if (!first_steps) {
+        return;
+    }
+
+    //paths are symmetric, so the node before start on the goal->start path
+    //is the first step on the start->goal path, no need to walk the path
+    for (int i = 0; i < goal_count; ++i) {
+        if (distances[i] == std::numeric_limits<float>::max()) {
+            first_steps[i] = GridPos{ -1, -1 };
+            continue;
+        }
+        const int end_1d_index = goals[i].row * map_width + goals[i].col;
+        first_steps[i] = index_to_gridpos(rfw_closest_node_index[end_1d_index][start_1d_index]);
+    }
+}
+
+//FNV-1a over the map size and every wall, the key of the precompute cache file
+unsigned long long hash_terrain() {
+    unsigned long long hash = 14695981039346656037ull;
+    auto add_byte = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    };
+
+    add_byte(static_cast<unsigned char>(terrain->get_map_width()));
+    add_byte(static_cast<unsigned char>(terrain->get_map_height()));
+    for (int row = 0; row < terrain->get_map_height(); ++row) {
+        for (int col = 0; col < terrain->get_map_width(); ++col) {
+            add_byte(terrain->is_wall(row, col) ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+std::string precompute_cache_path(const std::string& directory, unsigned long long terrain_hash) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "astar_precompute_%016llx.bin", terrain_hash);
+    return directory + "/" + name;
+}
+
+unsigned long long align_cache_offset(unsigned long long offset) {
+    return (offset + precompute_cache_alignment - 1) & ~(precompute_cache_alignment - 1);
+}
+
+//header for the current terrain, with the section offsets filled in
+PrecomputeCacheHeader make_cache_header(unsigned long long terrain_hash) {
+    PrecomputeCacheHeader header{};
+    std::memcpy(header.magic, precompute_cache_magic, sizeof(header.magic));
+    header.version = precompute_cache_version;
+    header.map_width = terrain->get_map_width();
+    header.map_height = terrain->get_map_height();
+    header.cell_count = static_cast<unsigned>(header.map_width * header.map_height);
+    header.terrain_hash = terrain_hash;
+
+    const unsigned long long row_bytes = 40 * 40 * sizeof(float);
+    header.walls_offset = align_cache_offset(sizeof(PrecomputeCacheHeader));
+    header.neighbours_offset = align_cache_offset(header.walls_offset + header.cell_count);
+    header.distances_offset = align_cache_offset(header.neighbours_offset + header.cell_count);
+    header.closest_offset = align_cache_offset(header.distances_offset + header.cell_count * row_bytes);
+    header.file_size = header.closest_offset + header.cell_count * row_bytes;
+    return header;
+}
+
+/*
+    maps the cache file of the current terrain and points the Floyd-Warshall tables into it,
+    the neighbour masks are small enough to copy into node_map. Any mismatch (old version,
+    other map, truncated file) returns false and leaves the tables on their storage
+*/
+bool load_precompute_cache(const std::string& directory) {
+    const unsigned long long terrain_hash = hash_terrain();
+    if (!precompute_cache_file.open(precompute_cache_path(directory, terrain_hash).c_str())) {
+        return false;
+    }
+
+    const PrecomputeCacheHeader expected = make_cache_header(terrain_hash);
+    const unsigned char* bytes = precompute_cache_file.data();
+    if (precompute_cache_file.size() < sizeof(PrecomputeCacheHeader)) {
+        precompute_cache_file.close();
+        return false;
+    }
+    PrecomputeCacheHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(&header, &expected, sizeof(header)) != 0 ||
+        precompute_cache_file.size() != header.file_size) {
+        precompute_cache_file.close();
+        return false;
+    }
+
+    //a hash collision would hand out the wrong tables, so the walls are compared too
+    const unsigned char* walls = bytes + header.walls_offset;
+    for (int row = 0; row < header.map_height; ++row) {
+        for (int col = 0; col < header.map_width; ++col) {
+            if (walls[row * header.map_width + col] != (terrain->is_wall(row, col) ? 1 : 0)) {
+                precompute_cache_file.close();
+                return false;
+            }
+        }
+    }
+
+    const unsigned char* neighbours = bytes + header.neighbours_offset;
+    for (int row = 0; row < header.map_height; ++row) {
+        for (int col = 0; col < header.map_width; ++col) {
+            node_map[row][col].neighbours = neighbours[row * header.map_width + col];
+        }
+    }
+
+    //never written through while mapped, see release_precompute_cache
+    rfw_distances = reinterpret_cast<float(*)[40 * 40]>(const_cast<unsigned char*>(bytes + header.distances_offset));
+    rfw_closest_node_index = reinterpret_cast<int(*)[40 * 40]>(const_cast<unsigned char*>(bytes + header.closest_offset));
+    return true;
+}
+
+//writes to a temporary file first so a crash never leaves a half written cache behind
+void save_precompute_cache(const std::string& directory) {
+    const PrecomputeCacheHeader header = make_cache_header(hash_terrain());
+    const std::string path = precompute_cache_path(directory, header.terrain_hash);
+    const std::string temporary_path = path + ".tmp";
+    const int map_width = header.map_width;
+
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+
+        auto pad_to = [&out](unsigned long long offset) {
+            static const char zeros[precompute_cache_alignment] = {};
+            unsigned long long position = static_cast<unsigned long long>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(offset - position));
+        };
+
+        std::vector<unsigned char> cells(header.cell_count);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        pad_to(header.walls_offset);
+        for (unsigned i = 0; i < header.cell_count; ++i) {
+            cells[i] = terrain->is_wall(i / map_width, i % map_width) ? 1 : 0;
+        }
+        out.write(reinterpret_cast<const char*>(cells.data()), cells.size());
+
+        pad_to(header.neighbours_offset);
+        for (unsigned i = 0; i < header.cell_count; ++i) {
+            cells[i] = node_map[i / map_width][i % map_width].neighbours;
+        }
+        out.write(reinterpret_cast<const char*>(cells.data()), cells.size());
+
+        pad_to(header.distances_offset);
+        out.write(reinterpret_cast<const char*>(rfw_distances_storage), header.cell_count * sizeof(rfw_distances_storage[0]));
+        pad_to(header.closest_offset);
+        out.write(reinterpret_cast<const char*>(rfw_closest_node_index_storage), header.cell_count * sizeof(rfw_closest_node_index_storage[0]));
+
+        if (!out) {
+            out.close();
+            std::remove(temporary_path.c_str());
+            return;
+        }
+    }
+
+    std::remove(path.c_str());
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        std::remove(temporary_path.c_str());
+    }
+}
+
+void AStarPather::on_map_change() {
+    //both precomputes run under one lock so a search on another thread never
+    //sees new neighbours together with old Floyd-Warshall tables
+    std::lock_guard<std::mutex> lock(search_mutex);
+    release_precompute_cache();
+
+    if (precompute_cache_directory.empty() || !load_precompute_cache(precompute_cache_directory)) {
+        precompute_neighbours();
+        precompute_roy_floyd();
+        if (!precompute_cache_directory.empty()) {
+            save_precompute_cache(precompute_cache_directory);
+        }
+    }
+    ++map_version;
+}
+
+void AStarPather::set_precompute_cache_directory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    precompute_cache_directory = directory;
+}
+
+unsigned AStarPather::get_map_version() const {
+    return map_version;
+}
+
+void AStarPather::set_search_abort(bool abort) {
+    search_abort = abort;
+}
+
 bool AStarPather::initialize()
 {
     // handle any one-time setup requirements you have
@@ -159,17 +460,15 @@ bool AStarPather::initialize()
     */
 
 
-    Callback changeMapCallBack = std::bind(&AStarPather::precompute_neighbours, this);
+    Callback changeMapCallBack = std::bind(&AStarPather::on_map_change, this);
    Messenger::listen_for_message(Messages::MAP_CHANGE, changeMapCallBack);
 
-
-   Callback royFloydChangeMapCallBack = std::bind(&AStarPather::precompute_roy_floyd, this);
-   Messenger::listen_for_message(Messages::MAP_CHANGE, royFloydChangeMapCallBack);
-
     for (int i = 0; i < 40; ++i) {
         for (int u = 0; u < 40; ++u) {
             node_map[i][u].final_cost = 0.f;
             node_map[i][u].given_cost = 0.f;
+            node_map[i][u].final_cost_fixed = 0;
+            node_map[i][u].given_cost_fixed = 0;
             node_map[i][u].list_type = list::no_list;
             node_map[i][u].parent_row = -1;
             node_map[i][u].parent_col = -1;
@@ -194,6 +493,7 @@ bool AStarPather::initialize()
     }
 
 
+    release_precompute_cache();
     for (int i = 0; i < 40 * 40; ++i) {
         for (int j = 0; j < 40 * 40; ++j) {
                 rfw_distances[i][j] = std::numeric_limits<float>::max();
@@ -214,6 +514,8 @@ void AStarPather::shutdown()
         for (int u = 0; u < 40; ++u) {
             node_map[i][u].final_cost =0.f;
             node_map[i][u].given_cost = 0.f;
+            node_map[i][u].final_cost_fixed = 0;
+            node_map[i][u].given_cost_fixed = 0;
             node_map[i][u].list_type = list::no_list;
             node_map[i][u].neighbours = 0;
            // node_map[i][u].parent = nullptr;
@@ -234,8 +536,200 @@ void AStarPather::shutdown()
     for (int i = 0; i < num_portions; ++i) {
         active_portions[i] = 0;
     }
+
+    release_precompute_cache();
+}
+
+
+/*
+    heuristic cost from (row,col), when there are several goals the distance to the
+    closest one is used, which stays admissible for every goal in the list
+*/
+float calculate_heuristic(Heuristic heuristic, int row, int col, const GridPos* goals, int goal_count) {
+    float hx = std::numeric_limits<float>::max();
+
+    for (int g = 0; g < goal_count; ++g) {
+        float goal_hx{ 0.f };
+        float xdiff = static_cast<float>(std::abs(goals[g].col - col));
+        float ydiff = static_cast<float>(std::abs(goals[g].row - row));
+        float min = xdiff > ydiff ? ydiff : xdiff;
+        float max = xdiff > ydiff ? xdiff : ydiff;
+
+        switch (heuristic) {
+        case Heuristic::OCTILE:
+            goal_hx = min * 0.41f + max;
+            break;
+
+        case Heuristic::EUCLIDEAN:
+            goal_hx = sqrt(xdiff * xdiff + ydiff * ydiff);
+            break;
+
+        case Heuristic::INCONSISTENT:
+            if ((row + col) % 2 > 0) {
+                goal_hx = sqrt(xdiff * xdiff + ydiff * ydiff);
+            }
+            break;
+
+        case Heuristic::MANHATTAN:
+            goal_hx = xdiff + ydiff;
+            break;
+
+        case Heuristic::CHEBYSHEV:
+            goal_hx = max;
+            break;
+
+        default:
+            break;
+        }
+
+        if (goal_hx < hx) {
+            hx = goal_hx;
+        }
+    }
+    return hx;
 }
 
+/*
+    integer square root, floor(sqrt(value)), used instead of sqrt so the
+    fixed point euclidean heuristic does not depend on the floating point unit
+*/
+unsigned long long integer_sqrt(unsigned long long value) {
+    unsigned long long result = 0;
+    unsigned long long bit = 1ull << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+/*
+    same heuristics as calculate_heuristic, in units of 1/fixed_cost_scale of a cell
+*/
+int calculate_fixed_heuristic(Heuristic heuristic, int row, int col, const GridPos* goals, int goal_count) {
+    int hx = std::numeric_limits<int>::max();
+
+    for (int g = 0; g < goal_count; ++g) {
+        int goal_hx{ 0 };
+        long long xdiff = std::abs(goals[g].col - col);
+        long long ydiff = std::abs(goals[g].row - row);
+        long long min = xdiff > ydiff ? ydiff : xdiff;
+        long long max = xdiff > ydiff ? xdiff : ydiff;
+
+        switch (heuristic) {
+        case Heuristic::OCTILE:
+            goal_hx = static_cast<int>(min * (fixed_diagonal_cost - fixed_cost_scale) + max * fixed_cost_scale);
+            break;
+
+        case Heuristic::EUCLIDEAN:
+            goal_hx = static_cast<int>(integer_sqrt(static_cast<unsigned long long>(xdiff * xdiff + ydiff * ydiff) * fixed_cost_scale * fixed_cost_scale));
+            break;
+
+        case Heuristic::INCONSISTENT:
+            if ((row + col) % 2 > 0) {
+                goal_hx = static_cast<int>(integer_sqrt(static_cast<unsigned long long>(xdiff * xdiff + ydiff * ydiff) * fixed_cost_scale * fixed_cost_scale));
+            }
+            break;
+
+        case Heuristic::MANHATTAN:
+            goal_hx = static_cast<int>((xdiff + ydiff) * fixed_cost_scale);
+            break;
+
+        case Heuristic::CHEBYSHEV:
+            goal_hx = static_cast<int>(max * fixed_cost_scale);
+            break;
+
+        default:
+            break;
+        }
+
+        if (goal_hx < hx) {
+            hx = goal_hx;
+        }
+    }
+    return hx;
+}
+
+/*
+    cost arithmetic used by AStarPather::search_with.
+    float_costs is the original floating point behaviour, 1 and 1.41 per step and
+    slices_per_interval buckets per unit of cost.
+    fixed_costs keeps every cost an integer scaled by fixed_cost_scale, so the bucket
+    of a cost is a shift and results are bit for bit the same on every compiler
+*/
+struct float_costs {
+    using cost_type = float;
+
+    static float& given(Node& node) { return node.given_cost; }
+    static float& final_cost(Node& node) { return node.final_cost; }
+    static float straight_step() { return 1.f; }
+    static float diagonal_step() { return root2; }
+    static float weight(float request_weight) { return request_weight; }
+    static float weighted(float hx, float weight) { return hx * weight; }
+    static float heuristic(Heuristic heuristic, int row, int col, const GridPos* goals, int goal_count) {
+        return calculate_heuristic(heuristic, row, col, goals, goal_count);
+    }
+    static int bucket(float cost) { return static_cast<int>(cost * slices_per_interval); }
+};
+
+struct fixed_costs {
+    using cost_type = int;
+
+    static int& given(Node& node) { return node.given_cost_fixed; }
+    static int& final_cost(Node& node) { return node.final_cost_fixed; }
+    static int straight_step() { return fixed_cost_scale; }
+    static int diagonal_step() { return fixed_diagonal_cost; }
+
+    //weight is converted once per request, heuristic * weight then stays in integers
+    static int weight(float request_weight) { return static_cast<int>(request_weight * fixed_cost_scale + 0.5f); }
+    static int weighted(int hx, int weight) {
+        return static_cast<int>((static_cast<long long>(hx) * weight) >> fixed_cost_shift);
+    }
+    static int heuristic(Heuristic heuristic, int row, int col, const GridPos* goals, int goal_count) {
+        return calculate_fixed_heuristic(heuristic, row, col, goals, goal_count);
+    }
+    static int bucket(int cost) { return cost >> fixed_bucket_shift; }
+};
+
+/*
+    bucket of open_list_arr for a node whose cost falls in bucket_index. Costs past the
+    last bucket share it, and a full bucket hands the node to the nearest one with room.
+    A bucket is searched by exact cost, so this only loosens the order across buckets,
+    and the buckets together always hold every cell of the map
+*/
+int open_bucket_for(int bucket_index) {
+    bucket_index = std::min(bucket_index, open_list_size - 1);
+    for (int i = bucket_index; i < open_list_size; ++i) {
+        if (open_list_arr[i].second < mini_arr_size - 1) {
+            return i;
+        }
+    }
+    for (int i = bucket_index - 1; i >= 0; --i) {
+        if (open_list_arr[i].second < mini_arr_size - 1) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool is_goal_cell(const GridPos& pos, const GridPos* goals, int goal_count) {
+    for (int g = 0; g < goal_count; ++g) {
+        if (goals[g] == pos) {
+            return true;
+        }
+    }
+    return false;
+}
 
 PathResult AStarPather::compute_path(PathRequest &request)
 {
@@ -272,16 +766,192 @@ PathResult AStarPather::compute_path(PathRequest &request)
             IMPOSSIBLE - a path from start to goal does not exist, do not add start position to path
     */
 
-    // WRITE YOUR CODE HERE
+    const GridPos goal = terrain->get_grid_position(request.goal);
+    std::lock_guard<std::mutex> lock(search_mutex);
+    return search(request, &goal, 1, nullptr);
+}
 
-    
-    // Just sample code, safe to delete
-    const GridPos start = terrain->get_grid_position(request.start);
+PathResult AStarPather::compute_path_to_nearest(PathRequest& request, const std::vector<GridPos>& goals, GridPos& chosen_goal)
+{
+    if (goals.empty()) {
+        return PathResult::IMPOSSIBLE;
+    }
+    std::lock_guard<std::mutex> lock(search_mutex);
+    return search(request, goals.data(), static_cast<int>(goals.size()), &chosen_goal);
+}
+
+void AStarPather::set_cost_mode(CostMode mode) {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    cost_mode = mode;
+}
+
+CostMode AStarPather::get_cost_mode() const {
+    return cost_mode;
+}
+
+PathResult AStarPather::search(PathRequest& request, const GridPos* goals, int goal_count, GridPos* reached_goal)
+{
+    if (request.newRequest) {
+        current_stats = PathStats{};
+    }
+    PATH_STAT(stats_clock::time_point search_begin = stats_clock::now());
+    PATH_STAT(double path_ms_before = current_stats.rubber_banding_ms + current_stats.smoothing_ms);
+
+    PathResult result{};
+    if (cost_mode == CostMode::FIXED_POINT) {
+        result = search_with<fixed_costs>(request, goals, goal_count, reached_goal);
+    }
+    else {
+        result = search_with<float_costs>(request, goals, goal_count, reached_goal);
+    }
+
+#ifndef PATHFINDING_NO_STATS
+    //search time is the call minus whatever was spent building the path this call
+    double path_ms = current_stats.rubber_banding_ms + current_stats.smoothing_ms - path_ms_before;
+    current_stats.search_ms += elapsed_ms(search_begin, stats_clock::now()) - path_ms;
+    current_stats.path_length = static_cast<unsigned>(request.path.size());
+
+    if (result != PathResult::PROCESSING) {
+        ++total_stats.requests;
+        if (result == PathResult::COMPLETE) {
+            ++total_stats.completed;
+        }
+        total_stats.nodes_expanded += current_stats.nodes_expanded;
+        total_stats.nodes_pushed += current_stats.nodes_pushed;
+        total_stats.decrease_keys += current_stats.decrease_keys;
+        total_stats.bucket_scan_steps += current_stats.bucket_scan_steps;
+        total_stats.search_ms += current_stats.search_ms;
+        total_stats.rubber_banding_ms += current_stats.rubber_banding_ms;
+        total_stats.smoothing_ms += current_stats.smoothing_ms;
+        total_stats.path_length += current_stats.path_length;
+    }
+#endif
+
+    //coloring happens once per touched cell after the search, not inside it
+    if (request.settings.debugColoring && !defer_debug_coloring) {
+        replay_trace();
+    }
+    return result;
+}
+
+PathResult AStarPather::compute_path(PathRequest& request, PathStats& stats)
+{
     const GridPos goal = terrain->get_grid_position(request.goal);
+    std::lock_guard<std::mutex> lock(search_mutex);
+    PathResult result = search(request, &goal, 1, nullptr);
+    stats = current_stats;
+    return result;
+}
+
+PathStats AStarPather::get_last_stats() const {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    return current_stats;
+}
+
+PathStatsSnapshot AStarPather::get_stats_snapshot() const {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    return total_stats;
+}
+
+void AStarPather::reset_stats() {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    total_stats = PathStatsSnapshot{};
+}
+
+void AStarPather::set_defer_debug_coloring(bool defer) {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    defer_debug_coloring = defer;
+}
+
+void AStarPather::replay_debug_trace() {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    replay_trace();
+}
+
+/*
+    colors every cell touched since the last replay with the color of its latest
+    event. Records the ring has already overwritten are skipped
+*/
+void AStarPather::replay_trace() {
+    static unsigned char last_event[40 * 40];
+    static unsigned short touched_cells[40 * 40];
+    int touched_count = 0;
+
+    unsigned long long first = trace_replayed;
+    if (trace_count - first > trace_capacity) {
+        first = trace_count - trace_capacity;
+    }
+
+    for (unsigned long long i = first; i < trace_count; ++i) {
+        const TraceRecord& record = trace_records[i & trace_mask];
+        if (last_event[record.cell] == 0) {
+            touched_cells[touched_count++] = record.cell;
+        }
+        last_event[record.cell] = static_cast<unsigned char>(record.event) + 1;
+    }
+
+    for (int i = 0; i < touched_count; ++i) {
+        const unsigned short cell = touched_cells[i];
+        const TraceEvent event = static_cast<TraceEvent>(last_event[cell] - 1);
+        last_event[cell] = 0;
+
+        GridPos pos{ cell / terrain->get_map_width(), cell % terrain->get_map_width() };
+        if (event == TraceEvent::closed) {
+            terrain->set_color(pos, Colors::Yellow);
+        }
+        //the goal was opened before it was reached, it stays blue as it did when
+        //the search colored cells itself
+        else if (event == TraceEvent::opened || event == TraceEvent::request_start ||
+                 event == TraceEvent::goal_reached) {
+            terrain->set_color(pos, Colors::Blue);
+        }
+    }
+    trace_replayed = trace_count;
+}
+
+/*
+    writes the records still held by the ring as "step,row,col,event" lines,
+    oldest first. Returns false if the file cannot be opened
+*/
+bool AStarPather::dump_debug_trace(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(search_mutex);
+
+    std::ofstream out(filename);
+    if (!out) {
+        return false;
+    }
+
+    static const char* const event_names[] = { "request_start", "opened", "closed", "goal_reached" };
+    const int map_width = terrain->get_map_width();
+    unsigned long long first = trace_count > trace_capacity ? trace_count - trace_capacity : 0;
+
+    out << "step,row,col,event\n";
+    for (unsigned long long i = first; i < trace_count; ++i) {
+        const TraceRecord& record = trace_records[i & trace_mask];
+        out << record.step << ',' << record.cell / map_width << ',' << record.cell % map_width << ','
+            << event_names[static_cast<int>(record.event)] << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+void AStarPather::clear_debug_trace() {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    trace_count = 0;
+    trace_replayed = 0;
+    trace_step = 0;
+}
+
+template <typename Costs>
+PathResult AStarPather::search_with(PathRequest& request, const GridPos* goals, int goal_count, GridPos* reached_goal)
+{
+    using cost_type = typename Costs::cost_type;
+    const GridPos start = terrain->get_grid_position(request.start);
+    const cost_type weight = Costs::weight(request.settings.weight);
 
     if (request.newRequest) {
         if (request.settings.debugColoring) {
-            terrain->set_color(start, Colors::Blue);
+            trace_step = 0;
+            record_trace(start, TraceEvent::request_start);
         }
 
         request.path.clear();
@@ -303,11 +973,27 @@ PathResult AStarPather::compute_path(PathRequest &request)
 
         if (request.settings.method == Method::FLOYD_WARSHALL) {
             int start_1d_index = start.row * terrain->get_map_width() + start.col;
-            int end_1d_index = goal.row * terrain->get_map_width() + goal.col;
-            if (rfw_distances[start_1d_index][end_1d_index] == std::numeric_limits<float>::max()) {
+
+            //closest goal comes straight out of the distance table
+            int goal_index = 0;
+            float closest_distance = std::numeric_limits<float>::max();
+            for (int g = 0; g < goal_count; ++g) {
+                float distance = rfw_distances[start_1d_index][goals[g].row * terrain->get_map_width() + goals[g].col];
+                if (distance < closest_distance) {
+                    closest_distance = distance;
+                    goal_index = g;
+                }
+            }
+            if (closest_distance == std::numeric_limits<float>::max()) {
                 return PathResult::IMPOSSIBLE;
             }
 
+            const GridPos& goal = goals[goal_index];
+            int end_1d_index = goal.row * terrain->get_map_width() + goal.col;
+            if (reached_goal) {
+                *reached_goal = goal;
+            }
+
             request.path.push_front(terrain->get_world_position(goal));
             for (int curr = end_1d_index; curr != start_1d_index; curr = rfw_closest_node_index[start_1d_index][curr]) {
                 GridPos cell_grid_pos{};
@@ -321,54 +1007,20 @@ PathResult AStarPather::compute_path(PathRequest &request)
 
         }
 
-        float hx{};
-        float xdiff = static_cast<float>(std::abs(goal.col - start.col));
-       // float xdiff = (goal.col - start.col) < 0 ?  -static_cast<float>(goal.col-start.col) : static_cast<float>(goal.col - start.col);
-        float ydiff = static_cast<float>(std::abs(goal.row - start.row));
-       // float ydiff = (goal.row-start.row) < 0? -static_cast<float>(goal.row - start.row) : static_cast<float>(goal.row - start.row);
-        float min = xdiff > ydiff ? ydiff : xdiff;
-        float max = xdiff > ydiff ? xdiff : ydiff;
-
-        switch (request.settings.heuristic) {
-        case Heuristic::OCTILE:
-            hx = min* 0.41f + max;
-            break;
-
-        case Heuristic::EUCLIDEAN:
-            hx = (sqrt(xdiff * xdiff + ydiff*ydiff));
-            break;
-
-        case Heuristic::INCONSISTENT:
-            if ((start.row + start.col) % 2 > 0) {
-                hx = (sqrt(xdiff * xdiff + ydiff * ydiff));
-                break;
-            }
-            else {
-                break;
-            }
-
-        case Heuristic::MANHATTAN:
-            hx = xdiff+ydiff;
-            break;
-
-        case Heuristic::CHEBYSHEV:
-            hx = max;
-            break;
-
-        default:
-            break;
-        }
+        cost_type hx = Costs::heuristic(request.settings.heuristic, start.row, start.col, goals, goal_count);
 
         Node& start_node = node_map[start.row][start.col];
-        start_node.given_cost = 0.f;
-       start_node.final_cost = hx* request.settings.weight;
+        Costs::given(start_node) = 0;
+        Costs::final_cost(start_node) = Costs::weighted(hx, weight);
 
-       index_of_cheapest_bucket = static_cast<int>(start_node.final_cost * slices_per_interval);
+       index_of_cheapest_bucket = open_bucket_for(Costs::bucket(Costs::final_cost(start_node)));
+       start_node.open_bucket = static_cast<short>(index_of_cheapest_bucket);
 
        open_list_arr[index_of_cheapest_bucket].second = 0;
         open_list_arr[index_of_cheapest_bucket].first[0] = (&(node_map[start.row][start.col]));
         start_node.list_type = list::on_open_list;
-        active_portions[static_cast<int>(index_of_cheapest_bucket * (inv_portion_size))]++;
+        active_portions[index_of_cheapest_bucket / portion_size]++;
+        PATH_STAT(++current_stats.nodes_pushed);
 
 
 
@@ -379,17 +1031,28 @@ PathResult AStarPather::compute_path(PathRequest &request)
         int index_of_cheapest_in_mini_arr = 0;
         Node* cheapest_node = open_list_arr[index_of_cheapest_bucket].first[0];
 
+        //equal final costs go to the larger given cost, so ties do not depend on
+        //where a node happened to land in the bucket
         for (int i = 1; i <= open_list_arr[index_of_cheapest_bucket].second; ++i) {
-            if (open_list_arr[index_of_cheapest_bucket].first[i]->final_cost < cheapest_node->final_cost) {
-                cheapest_node = open_list_arr[index_of_cheapest_bucket].first[i];
+            Node* candidate = open_list_arr[index_of_cheapest_bucket].first[i];
+            if (Costs::final_cost(*candidate) < Costs::final_cost(*cheapest_node) ||
+                (Costs::final_cost(*candidate) == Costs::final_cost(*cheapest_node) && Costs::given(*candidate) > Costs::given(*cheapest_node))) {
+                cheapest_node = candidate;
                 index_of_cheapest_in_mini_arr = i;
             }
         }
 
         const Node& copy_of_cheapest_node = *cheapest_node;
-        if (copy_of_cheapest_node.grid_pos == goal) {
-            
-            request.path.push_front(terrain->get_world_position(goal));
+        if (is_goal_cell(copy_of_cheapest_node.grid_pos, goals, goal_count)) {
+            if (reached_goal) {
+                *reached_goal = copy_of_cheapest_node.grid_pos;
+            }
+            if (request.settings.debugColoring) {
+                record_trace(copy_of_cheapest_node.grid_pos, TraceEvent::goal_reached);
+            }
+
+            PATH_STAT(stats_clock::time_point path_begin = stats_clock::now());
+            request.path.push_front(terrain->get_world_position(copy_of_cheapest_node.grid_pos));
             if (request.settings.rubberBanding) {
                 while (cheapest_node->parent_row >= 0 && cheapest_node->parent_col >= 0) {
                     if (node_map[cheapest_node->parent_row][cheapest_node->parent_col].parent_row >= 0 &&
@@ -449,6 +1112,8 @@ PathResult AStarPather::compute_path(PathRequest &request)
                     cheapest_node = &node_map[cheapest_node->parent_row][cheapest_node->parent_col];
                 } 
             }
+            PATH_STAT(stats_clock::time_point smoothing_begin = stats_clock::now());
+            PATH_STAT(current_stats.rubber_banding_ms += elapsed_ms(path_begin, smoothing_begin));
             if (request.settings.smoothing) {
                 int inserted_count = 0;
 
@@ -524,17 +1189,20 @@ PathResult AStarPather::compute_path(PathRequest &request)
 
                 
             } //end of if (smoothing)
+            PATH_STAT(current_stats.smoothing_ms += elapsed_ms(smoothing_begin, stats_clock::now()));
             return PathResult::COMPLETE;
         }
 
 
         (cheapest_node)->list_type = list::on_closed_list;
+        PATH_STAT(++current_stats.nodes_expanded);
         open_list_arr[index_of_cheapest_bucket].first[index_of_cheapest_in_mini_arr] = &(*(open_list_arr[index_of_cheapest_bucket].first[open_list_arr[index_of_cheapest_bucket].second--]));
 
-            active_portions[static_cast<int>(index_of_cheapest_bucket* (inv_portion_size))]--;
+            active_portions[index_of_cheapest_bucket / portion_size]--;
 
         if (request.settings.debugColoring) {
-            terrain->set_color(cheapest_node->grid_pos, Colors::Yellow);
+            ++trace_step;
+            record_trace(cheapest_node->grid_pos, TraceEvent::closed);
         }
         int cheapest_node_row = copy_of_cheapest_node.grid_pos.row;
         int cheapest_node_col = copy_of_cheapest_node.grid_pos.col;
@@ -551,74 +1219,41 @@ PathResult AStarPather::compute_path(PathRequest &request)
                 continue;
             }
 
-            float given_cost{};
+            cost_type given_cost{};
             if ((neighbour_row != cheapest_node_row && neighbour_col == cheapest_node_col) || (neighbour_row == cheapest_node_row && neighbour_col != cheapest_node_col)) {
-                given_cost = copy_of_cheapest_node.given_cost + 1;
+                given_cost = Costs::given(*cheapest_node) + Costs::straight_step();
             }
             else {
-                given_cost = copy_of_cheapest_node.given_cost + 1.41f;
+                given_cost = Costs::given(*cheapest_node) + Costs::diagonal_step();
             }
 
-            float neighbour_node_hx{0.f};
-            //float xdiff = (goal.col - neighbour_col) < 0 ? -static_cast<float>(goal.col - neighbour_col) : static_cast<float>(goal.col - neighbour_col);
-            float xdiff = static_cast<float>(std::abs(goal.col - neighbour_col));
-            //float ydiff = (goal.row - neighbour_row) < 0 ? -static_cast<float>(goal.row - neighbour_row) : static_cast<float>(goal.row - neighbour_row);
-            float ydiff = static_cast<float>(std::abs(goal.row - neighbour_row));
-            float min = xdiff > ydiff ? ydiff : xdiff;
-            float max = xdiff > ydiff ? xdiff : ydiff;
-
-            switch (request.settings.heuristic) {
-            case Heuristic::OCTILE:
-                neighbour_node_hx = min * 0.41f + max;
-                break;
-
-            case Heuristic::EUCLIDEAN:
-
-                neighbour_node_hx = (sqrt(xdiff * xdiff + ydiff * ydiff));
-                break;
-
-            case Heuristic::INCONSISTENT:
-                if(static_cast<int>(neighbour_row + neighbour_col )%2 > 0){
-                    neighbour_node_hx = sqrt(xdiff * xdiff + ydiff * ydiff);
-                    break;
-                }
-                else {
-                    break;
-                }
-
-            case Heuristic::MANHATTAN:
-                neighbour_node_hx = xdiff + ydiff;
-                break;
-
-            case Heuristic::CHEBYSHEV:
-                neighbour_node_hx = max;
-                break;
-
-            default:
-                break;
-            }
-            float new_final_cost = given_cost + neighbour_node_hx * request.settings.weight;
+            cost_type neighbour_node_hx = Costs::heuristic(request.settings.heuristic, neighbour_row, neighbour_col, goals, goal_count);
+            cost_type new_final_cost = given_cost + Costs::weighted(neighbour_node_hx, weight);
+            int new_bucket_index;
 
             if (node_map[neighbour_row][neighbour_col].list_type == list::no_list) {
+                new_bucket_index = open_bucket_for(Costs::bucket(new_final_cost));
+                node_map[neighbour_row][neighbour_col].open_bucket = static_cast<short>(new_bucket_index);
 
                 node_map[neighbour_row][neighbour_col].list_type = list::on_open_list;
                 node_map[neighbour_row][neighbour_col].parent_row = cheapest_node->grid_pos.row;
                 node_map[neighbour_row][neighbour_col].parent_col = cheapest_node->grid_pos.col;
-                node_map[neighbour_row][neighbour_col].given_cost = given_cost;
-                node_map[neighbour_row][neighbour_col].final_cost = new_final_cost;
+                Costs::given(node_map[neighbour_row][neighbour_col]) = given_cost;
+                Costs::final_cost(node_map[neighbour_row][neighbour_col]) = new_final_cost;
 
-                if (open_list_arr[static_cast<int>(new_final_cost * slices_per_interval)].second <= -2) {
-                    open_list_arr[static_cast<int>(new_final_cost * slices_per_interval)].second = -1;
+                if (open_list_arr[new_bucket_index].second <= -2) {
+                    open_list_arr[new_bucket_index].second = -1;
                 }
-                 open_list_arr[static_cast<int>(new_final_cost * slices_per_interval)].first[++(open_list_arr[static_cast<int>(new_final_cost * slices_per_interval)]).second] = &(node_map[neighbour_row][neighbour_col]);
+                 open_list_arr[new_bucket_index].first[++(open_list_arr[new_bucket_index]).second] = &(node_map[neighbour_row][neighbour_col]);
                  
-                 active_portions[(static_cast<int>(new_final_cost * slices_per_interval* inv_portion_size))]++;
+                 active_portions[new_bucket_index / portion_size]++;
+                 PATH_STAT(++current_stats.nodes_pushed);
 
-                    if (static_cast<int>(new_final_cost * slices_per_interval) < index_of_cheapest_bucket) {
-                        index_of_cheapest_bucket = static_cast<int>(new_final_cost * slices_per_interval);
+                    if (new_bucket_index < index_of_cheapest_bucket) {
+                        index_of_cheapest_bucket = new_bucket_index;
                     }
                     if (request.settings.debugColoring) {
-                        terrain->set_color(node_map[neighbour_row][neighbour_col].grid_pos, Colors::Blue);
+                        record_trace(node_map[neighbour_row][neighbour_col].grid_pos, TraceEvent::opened);
                     }
 
                 }
@@ -626,17 +1261,15 @@ PathResult AStarPather::compute_path(PathRequest &request)
                 /*
                  if code reaches here, list_type is definitely open_list or closed list
                 */
-                else if (new_final_cost < node_map[neighbour_row][neighbour_col].final_cost) {
-
-                    int new_bucket_index = static_cast<int>(new_final_cost * slices_per_interval);
+                else if (new_final_cost < Costs::final_cost(node_map[neighbour_row][neighbour_col])) {
 
                     if (node_map[neighbour_row][neighbour_col].list_type == list::on_open_list) {
-                        int old_bucket_index = static_cast<int>(node_map[neighbour_row][neighbour_col].final_cost * slices_per_interval);
-                        for (int i = 0; i < open_list_arr[old_bucket_index].second; ++i) {
+                        int old_bucket_index = node_map[neighbour_row][neighbour_col].open_bucket;
+                        for (int i = 0; i <= open_list_arr[old_bucket_index].second; ++i) {
                             Node* tmp = open_list_arr[old_bucket_index].first[i];
                                 if (tmp->grid_pos == node_map[neighbour_row][neighbour_col].grid_pos) {
                                     open_list_arr[old_bucket_index].first[i] = open_list_arr[old_bucket_index].first[open_list_arr[old_bucket_index].second--];
-                                        active_portions[static_cast<int>(old_bucket_index * inv_portion_size)]--;
+                                        active_portions[old_bucket_index / portion_size]--;
 
                                     break;
                                 }
@@ -645,15 +1278,24 @@ PathResult AStarPather::compute_path(PathRequest &request)
                     }
 
 
-                    node_map[neighbour_row][neighbour_col].final_cost = new_final_cost;
+                    new_bucket_index = open_bucket_for(Costs::bucket(new_final_cost));
+                    node_map[neighbour_row][neighbour_col].open_bucket = static_cast<short>(new_bucket_index);
+                    Costs::final_cost(node_map[neighbour_row][neighbour_col]) = new_final_cost;
                     node_map[neighbour_row][neighbour_col].parent_row = cheapest_node->grid_pos.row;
                     node_map[neighbour_row][neighbour_col].parent_col = cheapest_node->grid_pos.col;
-                    node_map[neighbour_row][neighbour_col].given_cost = given_cost;
+                    Costs::given(node_map[neighbour_row][neighbour_col]) = given_cost;
                     node_map[neighbour_row][neighbour_col].list_type = list::on_open_list;
 
                    
                     open_list_arr[new_bucket_index].first[++(open_list_arr[new_bucket_index].second)] = &node_map[neighbour_row][neighbour_col];
-                    active_portions[static_cast<int>(new_bucket_index *inv_portion_size)]++;
+                    active_portions[new_bucket_index / portion_size]++;
+                    PATH_STAT(++current_stats.nodes_pushed);
+                    PATH_STAT(++current_stats.decrease_keys);
+
+                    //only possible with an inconsistent heuristic, but the cheapest bucket must follow it
+                    if (new_bucket_index < index_of_cheapest_bucket) {
+                        index_of_cheapest_bucket = new_bucket_index;
+                    }
 
                 }
             
@@ -661,8 +1303,10 @@ PathResult AStarPather::compute_path(PathRequest &request)
         if (open_list_arr[index_of_cheapest_bucket].second < 0) {
             index_of_cheapest_bucket = -1;
             for (int i = 0; i < num_portions; ++i) {
+                PATH_STAT(++current_stats.bucket_scan_steps);
                 if (active_portions[i] > 0) {
                     for (int u = 0; u < portion_size; ++u) {
+                        PATH_STAT(++current_stats.bucket_scan_steps);
                         if (open_list_arr[i * portion_size + u].second >= 0) {
                             index_of_cheapest_bucket = i * portion_size + u;
                             break;
@@ -677,7 +1321,7 @@ PathResult AStarPather::compute_path(PathRequest &request)
                 
             }
         }
-        if (request.settings.singleStep) {
+        if (request.settings.singleStep || search_abort.load(std::memory_order_relaxed)) {
             return PathResult::PROCESSING;
         }
     }
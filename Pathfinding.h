@@ -1,5 +1,52 @@
 #pragma once
+#ifdef PATHFINDING_HEADLESS
+#include "PathfindingHeadless.h"
+#else
 #include "Misc/PathfindingDetails.hpp"
+#endif
+#include <mutex>
+#include <atomic>
+#include <string>
+
+/*
+    FLOAT is the original cost model. FIXED_POINT runs the search on integer costs
+    (1 cell = 1024) so the same request always expands the same nodes and returns
+    the same path on every compiler and platform, for lockstep games.
+*/
+enum class CostMode {
+    FLOAT, FIXED_POINT
+};
+
+/*
+    Counters for one request, accumulated over every call of a single step request.
+    rubber_banding_ms covers walking the parents into request.path (with or without
+    rubber banding), search_ms is everything else. Define PATHFINDING_NO_STATS to
+    compile the counting out, the structs then stay zero.
+*/
+struct PathStats {
+    unsigned nodes_expanded;
+    unsigned nodes_pushed;
+    unsigned decrease_keys;
+    unsigned bucket_scan_steps;
+    double search_ms;
+    double rubber_banding_ms;
+    double smoothing_ms;
+    unsigned path_length;
+};
+
+//totals over every finished request since the last reset_stats
+struct PathStatsSnapshot {
+    unsigned long long requests;
+    unsigned long long completed;
+    unsigned long long nodes_expanded;
+    unsigned long long nodes_pushed;
+    unsigned long long decrease_keys;
+    unsigned long long bucket_scan_steps;
+    double search_ms;
+    double rubber_banding_ms;
+    double smoothing_ms;
+    unsigned long long path_length;
+};
 
 class AStarPather
 {
@@ -25,6 +72,87 @@ public:
     void precompute_neighbours();
     void precompute_roy_floyd();
 
+    /*
+        MAP_CHANGE handler, runs both precomputes under search_mutex and bumps
+        the map version. get_map_version lets callers on other threads tell
+        whether the map changed while their search was running.
+    */
+    void on_map_change();
+    unsigned get_map_version() const;
+
+    /*
+        While set, a search running on another thread gives up at its next expansion
+        and returns PROCESSING without a path, as if single stepping. PathJobQueue
+        uses it to stop its worker before the terrain is edited.
+    */
+    void set_search_abort(bool abort);
+
+    /*
+        With a directory set, on_map_change first looks there for a cache file of the
+        current walls and memory maps its Floyd-Warshall tables instead of running the
+        precompute, and writes the file after a precompute that missed.
+        Empty (the default) turns the cache off. The directory must already exist.
+    */
+    void set_precompute_cache_directory(const std::string& directory);
+
+    /*
+        Distance-only lookup on the Floyd-Warshall tables, no path is built.
+        distances[i] is the travel cost from start to goals[i], or
+        std::numeric_limits<float>::max() if goals[i] cannot be reached.
+        If first_steps is given, first_steps[i] is the cell to move to first
+        ({-1,-1} when unreachable, start itself when start == goals[i]).
+    */
+    void query_distances(const GridPos& start, const GridPos* goals, int goal_count,
+        float* distances, GridPos* first_steps = nullptr) const;
+
+    /*
+        Path to whichever cell in goals is closest, found with a single search
+        (request.goal is ignored). chosen_goal is set to the goal that was reached.
+        In single step mode the same goals must be passed on every call.
+    */
+    PathResult compute_path_to_nearest(PathRequest& request, const std::vector<GridPos>& goals, GridPos& chosen_goal);
+
+    //mode applies to requests started after the call, do not change it mid single step
+    void set_cost_mode(CostMode mode);
+    CostMode get_cost_mode() const;
+
+    /*
+        With debugColoring on, the search only appends (cell, event, step) records to
+        a ring buffer, and the terrain is colored from them when the search returns.
+        With deferred coloring the records are kept until replay_debug_trace is called.
+        dump_debug_trace writes whatever the ring still holds to a csv file.
+    */
+    void set_defer_debug_coloring(bool defer);
+    void replay_debug_trace();
+    bool dump_debug_trace(const std::string& filename) const;
+    void clear_debug_trace();
+
+    /*
+        compute_path that also hands back the counters of the request,
+        get_last_stats returns the same for whichever request ran last.
+        get_stats_snapshot can be polled from any thread
+    */
+    PathResult compute_path(PathRequest& request, PathStats& stats);
+    PathStats get_last_stats() const;
+    PathStatsSnapshot get_stats_snapshot() const;
+    void reset_stats();
+
+private:
+    PathResult search(PathRequest& request, const GridPos* goals, int goal_count, GridPos* reached_goal);
+    template <typename Costs>
+    PathResult search_with(PathRequest& request, const GridPos* goals, int goal_count, GridPos* reached_goal);
+    void replay_trace();
+
+    //search state is global, so only one search (or precompute) may run at a time
+    mutable std::mutex search_mutex;
+    std::atomic<unsigned> map_version{ 0 };
+    std::atomic<bool> search_abort{ false };
+    CostMode cost_mode{ CostMode::FLOAT };
+    bool defer_debug_coloring{ false };
+    PathStats current_stats{};
+    PathStatsSnapshot total_stats{};
+    std::string precompute_cache_directory;
+
 };
 
 
@@ -40,12 +168,28 @@ struct Node {
     GridPos grid_pos;
     float given_cost;
     float final_cost;
+    int given_cost_fixed;
+    int final_cost_fixed;
     list list_type;
     unsigned char neighbours;
 
     char parent_row;
     char parent_col;
 
+    //bucket of open_list_arr the node sits in while on the open list
+    short open_bucket;
+
+};
+
+enum class TraceEvent : unsigned char {
+    request_start, opened, closed, goal_reached
+};
+
+//one debug trace entry, cell is row * map width + col, step is the expansion count
+struct TraceRecord {
+    unsigned short cell;
+    TraceEvent event;
+    unsigned step;
 };
 
 int const open_list_size = 600;
@@ -0,0 +1,343 @@
+/*
+    Headless AStarPather benchmark.
+
+    Builds synthetic maps (open field, rooms and doors, maze, random obstacles),
+    replays a fixed set of start/goal requests on each one through compute_path for
+    every method, heuristic and cost mode, and prints one JSON object per line:
+
+    {"map":"maze","size":40,"density":0.00,"method":"astar","heuristic":"octile",
+     "cost_mode":"float","requests":200,"complete":187,"expansions_per_sec":...,
+     "p50_us":...,"p99_us":...,"mean_path_cost":...,"precompute_ms":...,"peak_rss_kb":...}
+
+    Maps and requests come from a fixed seed, so two runs of the same build replay the
+    exact same work and their output can be diffed to track regressions.
+
+    Build:
+        g++ -std=c++17 -O2 -DPATHFINDING_HEADLESS PathfindingBenchmark.cpp Pathfinding.cpp -o pathfinding_benchmark -pthread
+
+    Usage:
+        pathfinding_benchmark [--sizes 20,30,40] [--requests 200] [--seed 1] [--out results.jsonl]
+
+    Sizes are capped at 40, the largest map the pathfinder's fixed tables hold.
+*/
+#include "PathfindingHeadless.h"
+#include "Pathfinding.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+std::unique_ptr<Terrain> terrain;
+
+namespace {
+
+    enum class MapType {
+        open_field, rooms, maze, random_obstacles
+    };
+
+    const char* map_type_name(MapType type) {
+        switch (type) {
+        case MapType::open_field: return "open";
+        case MapType::rooms: return "rooms";
+        case MapType::maze: return "maze";
+        case MapType::random_obstacles: return "random";
+        }
+        return "unknown";
+    }
+
+    const char* heuristic_name(Heuristic heuristic) {
+        switch (heuristic) {
+        case Heuristic::OCTILE: return "octile";
+        case Heuristic::CHEBYSHEV: return "chebyshev";
+        case Heuristic::MANHATTAN: return "manhattan";
+        case Heuristic::EUCLIDEAN: return "euclidean";
+        case Heuristic::INCONSISTENT: return "inconsistent";
+        default: return "unknown";
+        }
+    }
+
+    int random_below(std::mt19937& rng, int bound) {
+        return static_cast<int>(bench::random_below(rng, static_cast<unsigned>(bound)));
+    }
+
+    void build_rooms(int size, std::mt19937& rng) {
+        const int room_size = 8;
+
+        //wall lines every room_size cells
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                if ((row % room_size == room_size - 1) || (col % room_size == room_size - 1)) {
+                    terrain->set_wall(row, col, true);
+                }
+            }
+        }
+
+        //one door in every wall segment between two rooms
+        for (int room_row = 0; room_row * room_size < size; ++room_row) {
+            for (int room_col = 0; room_col * room_size < size; ++room_col) {
+                int top = room_row * room_size;
+                int left = room_col * room_size;
+                int right_wall = left + room_size - 1;
+                int bottom_wall = top + room_size - 1;
+
+                if (right_wall < size - 1) {
+                    int door_row = std::min(size - 1, top + random_below(rng, room_size - 1));
+                    terrain->set_wall(door_row, right_wall, false);
+                }
+                if (bottom_wall < size - 1) {
+                    int door_col = std::min(size - 1, left + random_below(rng, room_size - 1));
+                    terrain->set_wall(bottom_wall, door_col, false);
+                }
+            }
+        }
+    }
+
+    //depth first maze carved on the odd cells
+    void build_maze(int size, std::mt19937& rng) {
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                terrain->set_wall(row, col, true);
+            }
+        }
+
+        const int dirs[4][2] = { {-2, 0}, {2, 0}, {0, -2}, {0, 2} };
+        std::vector<GridPos> stack;
+        stack.push_back(GridPos{ 1, 1 });
+        terrain->set_wall(1, 1, false);
+
+        while (!stack.empty()) {
+            GridPos cell = stack.back();
+            int options[4];
+            int option_count = 0;
+
+            for (int i = 0; i < 4; ++i) {
+                int row = cell.row + dirs[i][0];
+                int col = cell.col + dirs[i][1];
+                if (row > 0 && col > 0 && row < size - 1 && col < size - 1 && terrain->is_wall(row, col)) {
+                    options[option_count++] = i;
+                }
+            }
+
+            if (option_count == 0) {
+                stack.pop_back();
+                continue;
+            }
+
+            int dir = options[random_below(rng, option_count)];
+            int row = cell.row + dirs[dir][0];
+            int col = cell.col + dirs[dir][1];
+            terrain->set_wall(cell.row + dirs[dir][0] / 2, cell.col + dirs[dir][1] / 2, false);
+            terrain->set_wall(row, col, false);
+            stack.push_back(GridPos{ row, col });
+        }
+    }
+
+    void build_random(int size, float density, std::mt19937& rng) {
+        const int threshold = static_cast<int>(density * 1000.f);
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                terrain->set_wall(row, col, random_below(rng, 1000) < threshold);
+            }
+        }
+    }
+
+    void build_map(MapType type, int size, float density, std::mt19937& rng) {
+        terrain->resize(size, size);
+
+        switch (type) {
+        case MapType::open_field:
+            break;
+        case MapType::rooms:
+            build_rooms(size, rng);
+            break;
+        case MapType::maze:
+            build_maze(size, rng);
+            break;
+        case MapType::random_obstacles:
+            build_random(size, density, rng);
+            break;
+        }
+    }
+
+    std::vector<std::pair<GridPos, GridPos>> build_requests(int count, std::mt19937& rng) {
+        std::vector<GridPos> open_cells;
+        for (int row = 0; row < terrain->get_map_height(); ++row) {
+            for (int col = 0; col < terrain->get_map_width(); ++col) {
+                if (!terrain->is_wall(row, col)) {
+                    open_cells.push_back(GridPos{ row, col });
+                }
+            }
+        }
+
+        std::vector<std::pair<GridPos, GridPos>> requests;
+        if (open_cells.empty()) {
+            return requests;
+        }
+        for (int i = 0; i < count; ++i) {
+            const GridPos& start = open_cells[random_below(rng, static_cast<int>(open_cells.size()))];
+            const GridPos& goal = open_cells[random_below(rng, static_cast<int>(open_cells.size()))];
+            requests.emplace_back(start, goal);
+        }
+        return requests;
+    }
+
+    //length of the waypoint list in cells
+    double path_cost(const WaypointList& path) {
+        double cost = 0.0;
+        auto prev = path.begin();
+        if (prev == path.end()) {
+            return cost;
+        }
+        for (auto curr = std::next(prev); curr != path.end(); ++curr, ++prev) {
+            Vec3 diff = *curr - *prev;
+            cost += std::sqrt(diff.x * diff.x + diff.z * diff.z);
+        }
+        return cost;
+    }
+
+    using bench::peak_rss_kb;
+
+    struct RunConfig {
+        MapType map_type;
+        int size;
+        float density;
+        Method method;
+        Heuristic heuristic;
+        CostMode cost_mode;
+    };
+
+    void run(AStarPather& pather, const RunConfig& config, const std::vector<std::pair<GridPos, GridPos>>& requests,
+        double precompute_ms, std::ostream& out) {
+
+        pather.set_cost_mode(config.cost_mode);
+
+        std::vector<double> latencies_us;
+        latencies_us.reserve(requests.size());
+        unsigned long long expansions = 0;
+        double total_us = 0.0;
+        double total_cost = 0.0;
+        int complete = 0;
+
+        for (const auto& pair : requests) {
+            PathRequest request;
+            request.start = terrain->get_world_position(pair.first);
+            request.goal = terrain->get_world_position(pair.second);
+            request.settings.method = config.method;
+            request.settings.heuristic = config.heuristic;
+
+            auto begin = std::chrono::steady_clock::now();
+            PathResult result = pather.compute_path(request);
+            auto end = std::chrono::steady_clock::now();
+
+            double us = std::chrono::duration<double, std::micro>(end - begin).count();
+            latencies_us.push_back(us);
+            total_us += us;
+            expansions += pather.get_last_stats().nodes_expanded;
+            if (result == PathResult::COMPLETE) {
+                ++complete;
+                total_cost += path_cost(request.path);
+            }
+        }
+
+        std::sort(latencies_us.begin(), latencies_us.end());
+        auto percentile = [&latencies_us](double p) {
+            if (latencies_us.empty()) {
+                return 0.0;
+            }
+            size_t index = static_cast<size_t>(p * (latencies_us.size() - 1) + 0.5);
+            return latencies_us[index];
+        };
+
+        char line[512];
+        std::snprintf(line, sizeof(line),
+            "{\"map\":\"%s\",\"size\":%d,\"density\":%.2f,\"method\":\"%s\",\"heuristic\":\"%s\","
+            "\"cost_mode\":\"%s\",\"requests\":%zu,\"complete\":%d,\"expansions\":%llu,"
+            "\"expansions_per_sec\":%.0f,\"p50_us\":%.2f,\"p99_us\":%.2f,\"mean_path_cost\":%.4f,"
+            "\"precompute_ms\":%.2f,\"peak_rss_kb\":%llu}",
+            map_type_name(config.map_type), config.size, config.density,
+            config.method == Method::FLOYD_WARSHALL ? "floyd_warshall" : "astar",
+            config.method == Method::FLOYD_WARSHALL ? "none" : heuristic_name(config.heuristic),
+            config.cost_mode == CostMode::FIXED_POINT ? "fixed" : "float",
+            requests.size(), complete, expansions,
+            total_us > 0.0 ? expansions / (total_us * 1e-6) : 0.0,
+            percentile(0.50), percentile(0.99),
+            complete > 0 ? total_cost / complete : 0.0,
+            precompute_ms, peak_rss_kb());
+        out << line << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<unsigned> sizes{ 20, 30, 40 };
+    unsigned request_count = 200;
+    unsigned seed = 1;
+    std::string out_file;
+
+    if (!bench::parse_options(argc, argv, {
+            { "--sizes", bench::set_unsigned_list(sizes) },
+            { "--requests", bench::set_unsigned(request_count) },
+            { "--seed", bench::set_unsigned(seed) },
+            { "--out", bench::set_string(out_file) } },
+            "[--sizes 20,30,40] [--requests 200] [--seed 1] [--out file]")) {
+        return 1;
+    }
+
+    //the pathfinder's fixed tables hold 40x40 at most
+    for (unsigned& size : sizes) {
+        size = std::min(size, 40u);
+    }
+
+    bench::Output output;
+    if (!output.open(out_file)) {
+        return 1;
+    }
+    std::ostream& out = output.stream();
+
+    terrain = std::make_unique<Terrain>();
+    AStarPather pather;
+    pather.initialize();
+
+    struct MapCase {
+        MapType type;
+        float density;
+    };
+    const MapCase map_cases[] = {
+        { MapType::open_field, 0.f },
+        { MapType::rooms, 0.f },
+        { MapType::maze, 0.f },
+        { MapType::random_obstacles, 0.1f },
+        { MapType::random_obstacles, 0.2f },
+        { MapType::random_obstacles, 0.3f },
+    };
+    const Heuristic heuristics[] = {
+        Heuristic::OCTILE, Heuristic::CHEBYSHEV, Heuristic::MANHATTAN, Heuristic::EUCLIDEAN, Heuristic::INCONSISTENT
+    };
+    const CostMode cost_modes[] = { CostMode::FLOAT, CostMode::FIXED_POINT };
+
+    for (int size : sizes) {
+        for (const MapCase& map_case : map_cases) {
+            std::mt19937 rng(seed);
+            build_map(map_case.type, size, map_case.density, rng);
+
+            auto begin = std::chrono::steady_clock::now();
+            Messenger::send_message(Messages::MAP_CHANGE);
+            auto end = std::chrono::steady_clock::now();
+            double precompute_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+            auto requests = build_requests(request_count, rng);
+
+            for (CostMode cost_mode : cost_modes) {
+                for (Heuristic heuristic : heuristics) {
+                    run(pather, RunConfig{ map_case.type, size, map_case.density, Method::ASTAR, heuristic, cost_mode },
+                        requests, precompute_ms, out);
+                }
+            }
+            run(pather, RunConfig{ map_case.type, size, map_case.density, Method::FLOYD_WARSHALL, Heuristic::OCTILE, CostMode::FLOAT },
+                requests, precompute_ms, out);
+        }
+    }
+
+    pather.shutdown();
+    return 0;
+}
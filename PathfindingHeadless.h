@@ -0,0 +1,160 @@
+#pragma once
+/*
+    Stand-in for the parts of the framework that AStarPather uses, so the pathfinder
+    can be built without a window or renderer (tools, benchmarks, servers).
+    Build Pathfinding.cpp with PATHFINDING_HEADLESS defined to use it.
+
+    Terrain here is a plain wall grid of at most 40x40 cells, cell (row, col) sits at
+    world position (col, 0, row). set_color only counts calls.
+*/
+#include <list>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <iostream>
+#include <string>
+#include <memory>
+#include <utility>
+
+struct Vec3 {
+    float x, y, z;
+
+    Vec3() : x(0.f), y(0.f), z(0.f) {}
+    Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    Vec3 operator+(const Vec3& rhs) const { return Vec3(x + rhs.x, y + rhs.y, z + rhs.z); }
+    Vec3 operator-(const Vec3& rhs) const { return Vec3(x - rhs.x, y - rhs.y, z - rhs.z); }
+    Vec3 operator*(float scale) const { return Vec3(x * scale, y * scale, z * scale); }
+
+    static Vec3 CatmullRom(const Vec3& v1, const Vec3& v2, const Vec3& v3, const Vec3& v4, float t) {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        return (v1 * (-t3 + 2.f * t2 - t) + v2 * (3.f * t3 - 5.f * t2 + 2.f) +
+            v3 * (-3.f * t3 + 4.f * t2 + t) + v4 * (t3 - t2)) * 0.5f;
+    }
+};
+
+struct GridPos {
+    int row;
+    int col;
+
+    bool operator==(const GridPos& rhs) const { return row == rhs.row && col == rhs.col; }
+    bool operator!=(const GridPos& rhs) const { return !(*this == rhs); }
+};
+
+using WaypointList = std::list<Vec3>;
+
+enum class Heuristic {
+    OCTILE, CHEBYSHEV, MANHATTAN, EUCLIDEAN, INCONSISTENT, NUM_ENTRIES
+};
+
+enum class Method {
+    ASTAR, FLOYD_WARSHALL, GOAL_BOUNDING, JPS_PLUS, NUM_ENTRIES
+};
+
+enum class PathResult {
+    PROCESSING, COMPLETE, IMPOSSIBLE
+};
+
+struct PathRequest {
+    Vec3 start;
+    Vec3 goal;
+    WaypointList path;
+    bool newRequest = true;
+
+    struct Settings {
+        Heuristic heuristic = Heuristic::OCTILE;
+        Method method = Method::ASTAR;
+        float weight = 1.f;
+        bool smoothing = false;
+        bool rubberBanding = false;
+        bool singleStep = false;
+        bool debugColoring = false;
+    } settings;
+};
+
+struct Color {
+    float r, g, b, a;
+};
+
+namespace Colors {
+    const Color Blue{ 0.f, 0.f, 1.f, 1.f };
+    const Color Yellow{ 1.f, 1.f, 0.f, 1.f };
+    const Color White{ 1.f, 1.f, 1.f, 1.f };
+}
+
+using Callback = std::function<void(void)>;
+
+enum class Messages {
+    MAP_CHANGE
+};
+
+class Messenger {
+public:
+    static void listen_for_message(Messages message, Callback callback) {
+        listeners().emplace_back(message, std::move(callback));
+    }
+
+    static void send_message(Messages message) {
+        for (auto& listener : listeners()) {
+            if (listener.first == message) {
+                listener.second();
+            }
+        }
+    }
+
+private:
+    static std::vector<std::pair<Messages, Callback>>& listeners() {
+        static std::vector<std::pair<Messages, Callback>> registered;
+        return registered;
+    }
+};
+
+class Terrain {
+public:
+    Terrain() : width(40), height(40), colored_cells(0), walls{} {}
+
+    //clears every wall, width and height are clamped to 1..40
+    void resize(int map_width, int map_height) {
+        width = map_width < 1 ? 1 : (map_width > 40 ? 40 : map_width);
+        height = map_height < 1 ? 1 : (map_height > 40 ? 40 : map_height);
+        for (auto& row : walls) {
+            row.fill(false);
+        }
+    }
+
+    void set_wall(int row, int col, bool wall) { walls[row][col] = wall; }
+
+    int get_map_width() const { return width; }
+    int get_map_height() const { return height; }
+
+    bool is_valid_grid_position(int row, int col) const { return row >= 0 && col >= 0 && row < height && col < width; }
+    bool is_valid_grid_position(const GridPos& pos) const { return is_valid_grid_position(pos.row, pos.col); }
+
+    bool is_wall(int row, int col) const { return walls[row][col]; }
+    bool is_wall(const GridPos& pos) const { return is_wall(pos.row, pos.col); }
+
+    GridPos get_grid_position(const Vec3& pos) const {
+        return GridPos{ static_cast<int>(std::lround(pos.z)), static_cast<int>(std::lround(pos.x)) };
+    }
+    Vec3 get_world_position(const GridPos& pos) const {
+        return Vec3(static_cast<float>(pos.col), 0.f, static_cast<float>(pos.row));
+    }
+    Vec3 get_world_position(int row, int col) const { return get_world_position(GridPos{ row, col }); }
+
+    void set_color(const GridPos&, const Color&) { ++colored_cells; }
+    void set_color(int, int, const Color&) { ++colored_cells; }
+
+    int get_colored_cells() const { return colored_cells; }
+
+private:
+    int width;
+    int height;
+    int colored_cells;
+    std::array<std::array<bool, 40>, 40> walls;
+};
+
+//defined by whatever program links the headless pathfinder
+extern std::unique_ptr<Terrain> terrain;